@@ -0,0 +1,138 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+// Measures the throughput of the code generation.
+//
+// Usage: cppast_benchmark_code_generator [<number of namespaces>]
+//
+// Generates the code of a synthetic file, once with a code_generator that appends every token
+// to a string through the virtual do_write_XXX() functions, once with the buffered_code_generator
+// and once with generate_code_parallel() for 1 to 16 threads.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <cppast/code_generator.hpp>
+#include <cppast/cpp_class.hpp>
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_member_variable.hpp>
+#include <cppast/cpp_namespace.hpp>
+#include <cppast/cpp_type.hpp>
+#include <cppast/cpp_variable.hpp>
+
+using namespace cppast;
+
+namespace
+{
+constexpr auto members_per_class = 16u;
+
+// the straightforward generator the buffered one is compared to
+class string_generator final : public code_generator
+{
+public:
+    std::string str;
+
+private:
+    void do_indent() override
+    {
+        ++indent_;
+    }
+
+    void do_unindent() override
+    {
+        if (indent_ != 0u)
+            --indent_;
+    }
+
+    void do_write_token_seq(string_view tokens) override
+    {
+        if (was_newline_)
+        {
+            str.append(indent_ * 4u, ' ');
+            was_newline_ = false;
+        }
+        str.append(tokens.c_str(), tokens.length());
+    }
+
+    void do_write_newline() override
+    {
+        str += '\n';
+        was_newline_ = true;
+    }
+
+    unsigned indent_      = 0u;
+    bool     was_newline_ = false;
+};
+
+std::unique_ptr<cpp_file> build_file(const cpp_entity_index& idx, unsigned namespaces)
+{
+    cpp_file::builder file("code_generator.cpp");
+    for (auto n = 0u; n != namespaces; ++n)
+    {
+        auto ns_name = "ns_" + std::to_string(n);
+        cpp_namespace::builder ns(ns_name, false, false);
+
+        cpp_class::builder c("type", cpp_class_kind::struct_t);
+        for (auto m = 0u; m != members_per_class; ++m)
+        {
+            auto name = "member_" + std::to_string(m);
+            c.add_child(cpp_member_variable::build(idx, cpp_entity_id(ns_name + "::type::" + name),
+                                                   name, cpp_builtin_type::build(cpp_int),
+                                                   nullptr, false));
+        }
+        ns.add_child(c.finish(idx, cpp_entity_id(ns_name + "::type"), type_safe::nullopt));
+
+        ns.add_child(cpp_variable::build(idx, cpp_entity_id(ns_name + "::var"), "var",
+                                         cpp_pointer_type::build(cpp_builtin_type::build(cpp_int)),
+                                         nullptr, cpp_storage_class_none, false));
+        file.add_child(ns.finish(idx, cpp_entity_id(ns_name)));
+    }
+    return file.finish(idx);
+}
+
+// returns the throughput in MB/s
+template <typename Func>
+double run(Func generate)
+{
+    auto begin = std::chrono::steady_clock::now();
+    auto size  = generate();
+    auto end   = std::chrono::steady_clock::now();
+
+    auto seconds = std::chrono::duration<double>(end - begin).count();
+    return double(size) / seconds / 1e6;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto namespaces = argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : 10000u;
+
+    cpp_entity_index idx;
+    auto             file = build_file(idx, namespaces);
+
+    auto unbuffered = run([&] {
+        string_generator generator;
+        generate_code(generator, *file);
+        return generator.str.size();
+    });
+    auto buffered = run([&] {
+        buffered_code_generator generator;
+        generate_code(generator, *file);
+        return generator.str().size();
+    });
+    std::cout << std::fixed << std::setprecision(2) << "unbuffered: " << unbuffered << " MB/s\n"
+              << "buffered:   " << buffered << " MB/s\n";
+
+    buffered_code_generator_factory factory = [] {
+        return std::unique_ptr<buffered_code_generator>(new buffered_code_generator());
+    };
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "parallel MB/s" << '\n';
+    for (auto threads = 1u; threads <= 16u; threads *= 2u)
+    {
+        auto parallel = run([&] { return generate_code_parallel(factory, *file, threads).size(); });
+        std::cout << std::setw(8) << threads << std::setw(16) << parallel << '\n';
+    }
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+// Measures the throughput of the cpp_entity_index under contention.
+//
+// Usage: cppast_benchmark_entity_index [<operations per thread>]
+//
+// For 1 to 64 threads, every thread performs lookups of random ids,
+// once read-only and once with every 16th operation being a registration.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cppast/cpp_entity.hpp>
+#include <cppast/cpp_entity_index.hpp>
+
+using namespace cppast;
+
+namespace
+{
+constexpr auto entity_count = 1u << 16u;
+
+// xorshift, so the threads don't share a random engine
+std::uint_least32_t next_random(std::uint_least32_t& state)
+{
+    state ^= state << 13u;
+    state ^= state >> 17u;
+    state ^= state << 5u;
+    return state;
+}
+
+double run(const cpp_entity_index& idx, const std::vector<cpp_entity_id>& ids,
+           const std::vector<std::unique_ptr<cpp_entity>>& entities, unsigned threads,
+           unsigned operations, bool write)
+{
+    std::atomic<bool>        start(false);
+    std::atomic<unsigned>    found(0u);
+    std::vector<std::thread> workers;
+    for (auto t = 0u; t != threads; ++t)
+        workers.emplace_back([&, t] {
+            std::uint_least32_t state = 2463534242u + t;
+            auto                count = 0u;
+            while (!start.load())
+                std::this_thread::yield();
+
+            for (auto i = 0u; i != operations; ++i)
+            {
+                auto index = next_random(state) % entity_count;
+                if (write && i % 16u == 0u)
+                    idx.register_forward_declaration(ids[index], type_safe::ref(*entities[index]));
+                else if (idx.lookup(ids[index]))
+                    ++count;
+            }
+            found += count;
+        });
+
+    auto begin = std::chrono::steady_clock::now();
+    start      = true;
+    for (auto& worker : workers)
+        worker.join();
+    auto end = std::chrono::steady_clock::now();
+
+    if (found.load() == 0u)
+        std::cerr << "no entity found\n";
+    auto seconds = std::chrono::duration<double>(end - begin).count();
+    return double(threads) * double(operations) / seconds / 1e6;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto operations = argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : 1000000u;
+
+    std::vector<cpp_entity_id>               ids;
+    std::vector<std::unique_ptr<cpp_entity>> entities;
+    cpp_entity_index                         idx;
+    for (auto i = 0u; i != entity_count; ++i)
+    {
+        ids.emplace_back("entity_" + std::to_string(i));
+        entities.push_back(cpp_unexposed_entity::build(cpp_token_string::tokenize("int")));
+        // register half of the entities, the others are registered by the writers
+        if (i % 2u == 0u)
+            idx.register_definition(ids.back(), type_safe::ref(*entities.back()));
+    }
+
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "read Mop/s" << std::setw(16)
+              << "mixed Mop/s" << '\n';
+    for (auto threads = 1u; threads <= 64u; threads *= 2u)
+    {
+        auto read  = run(idx, ids, entities, threads, operations, false);
+        auto mixed = run(idx, ids, entities, threads, operations, true);
+        std::cout << std::setw(8) << threads << std::setw(16) << std::fixed << std::setprecision(2)
+                  << read << std::setw(16) << mixed << '\n';
+    }
+}
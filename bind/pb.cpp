@@ -4,7 +4,7 @@
 #include "pb.hpp"
 
 #include <algorithm>
-#include <cppast/cpp_type_alias.hpp>
+#include <cppast/cpp_type_printer.hpp>
 
 void print_warn(const std::string& msg)
 {
@@ -83,37 +83,14 @@ Context::Context(Context const& ctx, cppast::cpp_access_specifier_kind access) :
 }
 
 std::string Context::to_string(cppast::cpp_type const& type) {
-  class to_string_generator : public cppast::code_generator {
-   public:
-    to_string_generator(std::map<std::string, std::string> const& tpl_args) : tpl_args(tpl_args) {}
-
-    std::string get()
-    {
-        return std::move(result_);
-    }
-
-   private:
-    void do_indent() override {}
-
-    void do_unindent() override {}
-
-    void do_write_token_seq(cppast::string_view tokens) override
-    {
-      std::string str = tokens.c_str();
-      if (tpl_args.contains(str)) result_ += tpl_args.at(str);
-      else result_ += str;
-    }
-
-    std::string result_;
-    std::map<std::string, std::string> const& tpl_args;
-  } generator(tpl_args);
-
-  // just a dummy type for the output
-  static auto dummy_entity = cppast::cpp_type_alias::build("foo", cppast::cpp_builtin_type::build(cppast::cpp_int));
-  to_string_generator::output output(type_safe::ref(generator), type_safe::ref(*dummy_entity),
-                                     cppast::cpp_public);
-  cppast::detail::write_type(output, type, "");
-  return generator.get();
+  auto substitute = [](void* data, cppast::string_view token) -> std::string const* {
+    auto& args = *static_cast<std::map<std::string, std::string> const*>(data);
+    auto it = args.find(std::string(token.c_str(), token.length()));
+    return it == args.end() ? nullptr : &it->second;
+  };
+
+  cppast::cpp_type_printer printer(substitute, &tpl_args);
+  return printer.print(type);
 }
 
 bool Context::is_public() const {
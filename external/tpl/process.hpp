@@ -15,6 +15,7 @@ namespace TinyProcessLib {
 /// Additional parameters to Process constructors.
 struct Config {
   /// Buffer size for reading stdout and stderr. Default is 131072 (128 kB).
+  /// On Linux, the capacity of the stdout and stderr pipes is increased to this size if possible.
   std::size_t buffer_size = 131072;
   /// Set to true to inherit file descriptors from parent process. Default is false.
   /// On Windows: has no effect unless read_stdout==nullptr, read_stderr==nullptr and open_stdin==false.
@@ -159,6 +160,11 @@ private:
   id_type open(const string_type &command, const string_type &path, const environment_type *environment = nullptr) noexcept;
 #ifndef _WIN32
   id_type open(const std::function<void()> &function) noexcept;
+  bool create_pipes(int stdin_p[2], int stdout_p[2], int stderr_p[2]) noexcept;
+  void close_pipes(int stdin_p[2], int stdout_p[2], int stderr_p[2]) noexcept;
+  void use_pipes(id_type pid, int stdin_p[2], int stdout_p[2], int stderr_p[2]) noexcept;
+  bool can_spawn(const string_type &path) const noexcept;
+  id_type spawn(const char *file, const char *const *argv, const char *const *envp, const string_type &path) noexcept;
 #endif
   void async_read() noexcept;
   void close_fds() noexcept;
@@ -1,16 +1,72 @@
 #include "process.hpp"
 #include <algorithm>
 #include <bitset>
+#include <climits>
 #include <cstdlib>
 #include <fcntl.h>
 #include <poll.h>
 #include <set>
 #include <signal.h>
+#include <spawn.h>
 #include <stdexcept>
 #include <unistd.h>
 
+// posix_spawn() can only replace the fork() based implementation if it supports the options:
+// closing all other file descriptors requires glibc 2.34, changing the directory glibc 2.29.
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+#define TINY_PROCESS_LIB_SPAWN_CLOSEFROM
+#endif
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define TINY_PROCESS_LIB_SPAWN_CHDIR
+#endif
+
+extern char **environ;
+
 namespace TinyProcessLib {
 
+namespace {
+// Creates a pipe that isn't inherited by processes started concurrently by other threads.
+// The ends used by the child process are duplicated to 0, 1 or 2, which clears the flag.
+int make_pipe(int p[2]) noexcept {
+#ifdef __linux__
+  return pipe2(p, O_CLOEXEC);
+#else
+  if(pipe(p) != 0)
+    return -1;
+  fcntl(p[0], F_SETFD, FD_CLOEXEC);
+  fcntl(p[1], F_SETFD, FD_CLOEXEC);
+  return 0;
+#endif
+}
+
+// Makes the pipe as large as the read buffer, so the child process blocks less often on a full pipe.
+void set_pipe_size(int fd, std::size_t size) noexcept {
+#ifdef F_SETPIPE_SZ
+  fcntl(fd, F_SETPIPE_SZ, static_cast<int>(std::min<std::size_t>(size, INT_MAX)));
+#else
+  (void)fd;
+  (void)size;
+#endif
+}
+
+std::vector<std::string> make_environment_strings(const Process::environment_type &environment) {
+  std::vector<std::string> env_strs;
+  env_strs.reserve(environment.size());
+  for(const auto &e : environment)
+    env_strs.emplace_back(e.first + '=' + e.second);
+  return env_strs;
+}
+
+std::vector<const char *> make_pointers(const std::vector<std::string> &strings) {
+  std::vector<const char *> ptrs;
+  ptrs.reserve(strings.size() + 1);
+  for(auto &str : strings)
+    ptrs.emplace_back(str.c_str());
+  ptrs.emplace_back(nullptr);
+  return ptrs;
+}
+} // namespace
+
 Process::Data::Data() noexcept : id(-1) {}
 
 Process::Process(const std::function<void()> &function,
@@ -22,7 +78,7 @@ Process::Process(const std::function<void()> &function,
   async_read();
 }
 
-Process::id_type Process::open(const std::function<void()> &function) noexcept {
+bool Process::create_pipes(int stdin_p[2], int stdout_p[2], int stderr_p[2]) noexcept {
   if(open_stdin)
     stdin_fd = std::unique_ptr<fd_type>(new fd_type);
   if(read_stdout)
@@ -30,18 +86,16 @@ Process::id_type Process::open(const std::function<void()> &function) noexcept {
   if(read_stderr)
     stderr_fd = std::unique_ptr<fd_type>(new fd_type);
 
-  int stdin_p[2], stdout_p[2], stderr_p[2];
-
-  if(stdin_fd && pipe(stdin_p) != 0)
-    return -1;
-  if(stdout_fd && pipe(stdout_p) != 0) {
+  if(stdin_fd && make_pipe(stdin_p) != 0)
+    return false;
+  if(stdout_fd && make_pipe(stdout_p) != 0) {
     if(stdin_fd) {
       close(stdin_p[0]);
       close(stdin_p[1]);
     }
-    return -1;
+    return false;
   }
-  if(stderr_fd && pipe(stderr_p) != 0) {
+  if(stderr_fd && make_pipe(stderr_p) != 0) {
     if(stdin_fd) {
       close(stdin_p[0]);
       close(stdin_p[1]);
@@ -50,24 +104,54 @@ Process::id_type Process::open(const std::function<void()> &function) noexcept {
       close(stdout_p[0]);
       close(stdout_p[1]);
     }
-    return -1;
+    return false;
   }
+  return true;
+}
+
+void Process::close_pipes(int stdin_p[2], int stdout_p[2], int stderr_p[2]) noexcept {
+  if(stdin_fd) {
+    close(stdin_p[0]);
+    close(stdin_p[1]);
+  }
+  if(stdout_fd) {
+    close(stdout_p[0]);
+    close(stdout_p[1]);
+  }
+  if(stderr_fd) {
+    close(stderr_p[0]);
+    close(stderr_p[1]);
+  }
+}
+
+void Process::use_pipes(id_type pid, int stdin_p[2], int stdout_p[2], int stderr_p[2]) noexcept {
+  if(stdin_fd)
+    close(stdin_p[0]);
+  if(stdout_fd)
+    close(stdout_p[1]);
+  if(stderr_fd)
+    close(stderr_p[1]);
+
+  if(stdin_fd)
+    *stdin_fd = stdin_p[1];
+  if(stdout_fd)
+    *stdout_fd = stdout_p[0];
+  if(stderr_fd)
+    *stderr_fd = stderr_p[0];
+
+  closed = false;
+  data.id = pid;
+}
+
+Process::id_type Process::open(const std::function<void()> &function) noexcept {
+  int stdin_p[2], stdout_p[2], stderr_p[2];
+  if(!create_pipes(stdin_p, stdout_p, stderr_p))
+    return -1;
 
   id_type pid = fork();
 
   if(pid < 0) {
-    if(stdin_fd) {
-      close(stdin_p[0]);
-      close(stdin_p[1]);
-    }
-    if(stdout_fd) {
-      close(stdout_p[0]);
-      close(stdout_p[1]);
-    }
-    if(stderr_fd) {
-      close(stderr_p[0]);
-      close(stderr_p[1]);
-    }
+    close_pipes(stdin_p, stdout_p, stderr_p);
     return pid;
   }
   else if(pid == 0) {
@@ -77,18 +161,7 @@ Process::id_type Process::open(const std::function<void()> &function) noexcept {
       dup2(stdout_p[1], 1);
     if(stderr_fd)
       dup2(stderr_p[1], 2);
-    if(stdin_fd) {
-      close(stdin_p[0]);
-      close(stdin_p[1]);
-    }
-    if(stdout_fd) {
-      close(stdout_p[0]);
-      close(stdout_p[1]);
-    }
-    if(stderr_fd) {
-      close(stderr_p[0]);
-      close(stderr_p[1]);
-    }
+    close_pipes(stdin_p, stdout_p, stderr_p);
 
     if(!config.inherit_file_descriptors) {
       // Optimization on some systems: using 8 * 1024 (Debian's default _SC_OPEN_MAX) as fd_max limit
@@ -109,36 +182,105 @@ Process::id_type Process::open(const std::function<void()> &function) noexcept {
     _exit(EXIT_FAILURE);
   }
 
-  if(stdin_fd)
-    close(stdin_p[0]);
-  if(stdout_fd)
-    close(stdout_p[1]);
-  if(stderr_fd)
-    close(stderr_p[1]);
+  use_pipes(pid, stdin_p, stdout_p, stderr_p);
+  return pid;
+}
 
+bool Process::can_spawn(const string_type &path) const noexcept {
+#ifndef TINY_PROCESS_LIB_SPAWN_CLOSEFROM
+  if(!config.inherit_file_descriptors)
+    return false;
+#endif
+#ifndef TINY_PROCESS_LIB_SPAWN_CHDIR
+  if(!path.empty())
+    return false;
+#else
+  (void)path;
+#endif
+  return true;
+}
+
+Process::id_type Process::spawn(const char *file, const char *const *argv, const char *const *envp, const string_type &path) noexcept {
+  int stdin_p[2], stdout_p[2], stderr_p[2];
+  if(!create_pipes(stdin_p, stdout_p, stderr_p))
+    return -1;
+
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  if(posix_spawn_file_actions_init(&actions) != 0) {
+    close_pipes(stdin_p, stdout_p, stderr_p);
+    return -1;
+  }
+  if(posix_spawnattr_init(&attr) != 0) {
+    posix_spawn_file_actions_destroy(&actions);
+    close_pipes(stdin_p, stdout_p, stderr_p);
+    return -1;
+  }
+
+  // Same setup as the child process of open(const std::function<void()> &), but without copying the page tables of the parent process
+  auto error = 0;
   if(stdin_fd)
-    *stdin_fd = stdin_p[1];
+    error = error ? error : posix_spawn_file_actions_adddup2(&actions, stdin_p[0], 0);
   if(stdout_fd)
-    *stdout_fd = stdout_p[0];
+    error = error ? error : posix_spawn_file_actions_adddup2(&actions, stdout_p[1], 1);
   if(stderr_fd)
-    *stderr_fd = stderr_p[0];
+    error = error ? error : posix_spawn_file_actions_adddup2(&actions, stderr_p[1], 2);
+#ifdef TINY_PROCESS_LIB_SPAWN_CLOSEFROM
+  if(!config.inherit_file_descriptors)
+    error = error ? error : posix_spawn_file_actions_addclosefrom_np(&actions, 3);
+#endif
+#ifdef TINY_PROCESS_LIB_SPAWN_CHDIR
+  if(!path.empty())
+    error = error ? error : posix_spawn_file_actions_addchdir_np(&actions, path.c_str());
+#else
+  (void)path;
+#endif
+
+  short flags = POSIX_SPAWN_SETPGROUP;
+#ifdef POSIX_SPAWN_USEVFORK
+  flags |= POSIX_SPAWN_USEVFORK;
+#endif
+  error = error ? error : posix_spawnattr_setpgroup(&attr, 0);
+  error = error ? error : posix_spawnattr_setflags(&attr, flags);
+
+  id_type pid = -1;
+  if(!error)
+    error = posix_spawn(&pid, file, &actions, &attr, const_cast<char *const *>(argv), const_cast<char *const *>(envp ? envp : environ));
+
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+
+  if(error) {
+    close_pipes(stdin_p, stdout_p, stderr_p);
+    return -1;
+  }
 
-  closed = false;
-  data.id = pid;
+  use_pipes(pid, stdin_p, stdout_p, stderr_p);
   return pid;
 }
 
 Process::id_type Process::open(const std::vector<string_type> &arguments, const string_type &path, const environment_type *environment) noexcept {
-  return open([&arguments, &path, &environment] {
-    if(arguments.empty())
-      exit(127);
+  if(arguments.empty())
+    return open([] { exit(127); });
+
+  // Created before starting the process, as allocating memory after fork() isn't safe with multiple threads
+  auto argv_ptrs = make_pointers(arguments);
+  std::vector<std::string> env_strs;
+  std::vector<const char *> env_ptrs;
+  if(environment) {
+    env_strs = make_environment_strings(*environment);
+    env_ptrs = make_pointers(env_strs);
+  }
 
-    std::vector<const char *> argv_ptrs;
-    argv_ptrs.reserve(arguments.size() + 1);
-    for(auto &argument : arguments)
-      argv_ptrs.emplace_back(argument.c_str());
-    argv_ptrs.emplace_back(nullptr);
+  // If posix_spawn() fails, e.g. because the file can't be executed, the fork() based implementation
+  // is used instead, so that the failure is still reported by a child process exiting with EXIT_FAILURE
+  if(can_spawn(path)) {
+    auto pid = spawn(arguments[0].c_str(), argv_ptrs.data(), environment ? env_ptrs.data() : nullptr, path);
+    if(pid >= 0)
+      return pid;
+  }
 
+  return open([&arguments, &path, &environment, &argv_ptrs, &env_ptrs] {
     if(!path.empty()) {
       if(chdir(path.c_str()) != 0)
         exit(1);
@@ -146,52 +288,45 @@ Process::id_type Process::open(const std::vector<string_type> &arguments, const
 
     if(!environment)
       execv(arguments[0].c_str(), const_cast<char *const *>(argv_ptrs.data()));
-    else {
-      std::vector<std::string> env_strs;
-      std::vector<const char *> env_ptrs;
-      env_strs.reserve(environment->size());
-      env_ptrs.reserve(environment->size() + 1);
-      for(const auto &e : *environment) {
-        env_strs.emplace_back(e.first + '=' + e.second);
-        env_ptrs.emplace_back(env_strs.back().c_str());
-      }
-      env_ptrs.emplace_back(nullptr);
-
+    else
       execve(arguments[0].c_str(), const_cast<char *const *>(argv_ptrs.data()), const_cast<char *const *>(env_ptrs.data()));
-    }
   });
 }
 
 Process::id_type Process::open(const std::string &command, const std::string &path, const environment_type *environment) noexcept {
-  return open([&command, &path, &environment] {
-    auto command_c_str = command.c_str();
-    std::string cd_path_and_command;
-    if(!path.empty()) {
-      auto path_escaped = path;
-      size_t pos = 0;
-      // Based on https://www.reddit.com/r/cpp/comments/3vpjqg/a_new_platform_independent_process_library_for_c11/cxsxyb7
-      while((pos = path_escaped.find('\'', pos)) != std::string::npos) {
-        path_escaped.replace(pos, 1, "'\\''");
-        pos += 4;
-      }
-      cd_path_and_command = "cd '" + path_escaped + "' && " + command; // To avoid resolving symbolic links
-      command_c_str = cd_path_and_command.c_str();
+  std::string cd_path_and_command;
+  if(!path.empty()) {
+    auto path_escaped = path;
+    size_t pos = 0;
+    // Based on https://www.reddit.com/r/cpp/comments/3vpjqg/a_new_platform_independent_process_library_for_c11/cxsxyb7
+    while((pos = path_escaped.find('\'', pos)) != std::string::npos) {
+      path_escaped.replace(pos, 1, "'\\''");
+      pos += 4;
     }
+    cd_path_and_command = "cd '" + path_escaped + "' && " + command; // To avoid resolving symbolic links
+  }
+  auto command_c_str = path.empty() ? command.c_str() : cd_path_and_command.c_str();
+
+  std::vector<std::string> env_strs;
+  std::vector<const char *> env_ptrs;
+  if(environment) {
+    env_strs = make_environment_strings(*environment);
+    env_ptrs = make_pointers(env_strs);
+  }
 
+  // The directory is changed by the shell
+  if(can_spawn(string_type())) {
+    const char *argv[] = {"/bin/sh", "-c", command_c_str, nullptr};
+    auto pid = spawn("/bin/sh", argv, environment ? env_ptrs.data() : nullptr, string_type());
+    if(pid >= 0)
+      return pid;
+  }
+
+  return open([&command_c_str, &environment, &env_ptrs] {
     if(!environment)
       execl("/bin/sh", "/bin/sh", "-c", command_c_str, nullptr);
-    else {
-      std::vector<std::string> env_strs;
-      std::vector<const char *> env_ptrs;
-      env_strs.reserve(environment->size());
-      env_ptrs.reserve(environment->size() + 1);
-      for(const auto &e : *environment) {
-        env_strs.emplace_back(e.first + '=' + e.second);
-        env_ptrs.emplace_back(env_strs.back().c_str());
-      }
-      env_ptrs.emplace_back(nullptr);
+    else
       execle("/bin/sh", "/bin/sh", "-c", command_c_str, nullptr, env_ptrs.data());
-    }
   });
 }
 
@@ -203,12 +338,14 @@ void Process::async_read() noexcept {
     std::vector<pollfd> pollfds;
     std::bitset<2> fd_is_stdout;
     if(stdout_fd) {
+      set_pipe_size(*stdout_fd, config.buffer_size);
       fd_is_stdout.set(pollfds.size());
       pollfds.emplace_back();
       pollfds.back().fd = fcntl(*stdout_fd, F_SETFL, fcntl(*stdout_fd, F_GETFL) | O_NONBLOCK) == 0 ? *stdout_fd : -1;
       pollfds.back().events = POLLIN;
     }
     if(stderr_fd) {
+      set_pipe_size(*stderr_fd, config.buffer_size);
       pollfds.emplace_back();
       pollfds.back().fd = fcntl(*stderr_fd, F_SETFL, fcntl(*stderr_fd, F_GETFL) | O_NONBLOCK) == 0 ? *stderr_fd : -1;
       pollfds.back().events = POLLIN;
@@ -220,14 +357,18 @@ void Process::async_read() noexcept {
       for(size_t i = 0; i < pollfds.size(); ++i) {
         if(pollfds[i].fd >= 0) {
           if(pollfds[i].revents & POLLIN) {
-            const ssize_t n = read(pollfds[i].fd, buffer.get(), config.buffer_size);
-            if(n > 0) {
-              if(fd_is_stdout[i])
-                read_stdout(buffer.get(), static_cast<size_t>(n));
-              else
-                read_stderr(buffer.get(), static_cast<size_t>(n));
-            }
-            else if(n < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+            // Read until the pipe is drained, so that poll() is only called again when it is empty
+            ssize_t n;
+            do {
+              n = read(pollfds[i].fd, buffer.get(), config.buffer_size);
+              if(n > 0) {
+                if(fd_is_stdout[i])
+                  read_stdout(buffer.get(), static_cast<size_t>(n));
+                else
+                  read_stderr(buffer.get(), static_cast<size_t>(n));
+              }
+            } while(n == static_cast<ssize_t>(config.buffer_size));
+            if(n < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
               pollfds[i].fd = -1;
               continue;
             }
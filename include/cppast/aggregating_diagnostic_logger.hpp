@@ -0,0 +1,91 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_AGGREGATING_DIAGNOSTIC_LOGGER_HPP_INCLUDED
+#define CPPAST_AGGREGATING_DIAGNOSTIC_LOGGER_HPP_INCLUDED
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include <cppast/detail/shared_mutex.hpp>
+#include <cppast/diagnostic_logger.hpp>
+
+namespace cppast
+{
+/// A diagnostic together with the number of times it was reported.
+struct aggregated_diagnostic
+{
+    const char* source;
+    diagnostic  diag;
+    std::size_t count;
+};
+
+/// A [cppast::diagnostic_logger]() that only forwards the first occurrence of a diagnostic.
+///
+/// Diagnostics are considered equal if they have the same file, line, severity and message,
+/// e.g. the same warning in a header that is included by multiple files.
+/// Repeated diagnostics are only counted and not forwarded,
+/// so they don't need to be formatted or printed again.
+/// The repeated diagnostics can be reported at the end by calling `log_summary()`.
+/// \notes This logger is thread safe if the target logger is thread safe.
+class aggregating_diagnostic_logger final : public diagnostic_logger
+{
+public:
+    /// \effects Creates it giving it the logger the first occurrences are forwarded to.
+    /// It is verbose if the target logger is verbose.
+    explicit aggregating_diagnostic_logger(type_safe::object_ref<const diagnostic_logger> target)
+    : diagnostic_logger(target->is_verbose()), target_(target), repeats_(0u)
+    {}
+
+    /// \returns All diagnostics that were logged, with the number of times they were reported.
+    /// They are sorted by the number of times in descending order,
+    /// then by file, line, severity and message.
+    std::vector<aggregated_diagnostic> summary() const;
+
+    /// \effects Logs an [cppast::severity::info]() diagnostic to the target logger for every
+    /// diagnostic that was reported more than once, stating the number of times,
+    /// in the order of `summary()`.
+    /// \returns The number of diagnostics that were logged.
+    std::size_t log_summary() const;
+
+    /// \returns The number of repeated diagnostics that weren't forwarded.
+    std::size_t repeats() const noexcept
+    {
+        return repeats_.load(std::memory_order_relaxed);
+    }
+
+    /// \returns A reference to the logger the diagnostics are forwarded to.
+    const diagnostic_logger& target() const noexcept
+    {
+        return *target_;
+    }
+
+private:
+    struct entry
+    {
+        const char*              source;
+        diagnostic               diag;
+        std::atomic<std::size_t> count;
+
+        entry(const char* src, const diagnostic& d) : source(src), diag(d), count(1u) {}
+    };
+
+    // the diagnostics are partitioned by hash into shards that are locked independently
+    struct shard
+    {
+        detail::shared_mutex                        mutex;
+        std::unordered_multimap<std::size_t, entry> map;
+    };
+
+    static constexpr unsigned shard_bits = 4u;
+
+    bool do_log(const char* source, const diagnostic& d) const override;
+
+    type_safe::object_ref<const diagnostic_logger> target_;
+    mutable shard                                  shards_[std::size_t(1u) << shard_bits];
+    mutable std::atomic<std::size_t>               repeats_;
+};
+} // namespace cppast
+
+#endif // CPPAST_AGGREGATING_DIAGNOSTIC_LOGGER_HPP_INCLUDED
@@ -0,0 +1,73 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_BUFFERED_DIAGNOSTIC_LOGGER_HPP_INCLUDED
+#define CPPAST_BUFFERED_DIAGNOSTIC_LOGGER_HPP_INCLUDED
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cppast/diagnostic_logger.hpp>
+
+namespace cppast
+{
+/// A [cppast::diagnostic_logger]() that buffers the diagnostics and emits them later.
+///
+/// Logging a diagnostic just pushes it onto a lock-free queue,
+/// so it never waits for other threads that are logging or for the output.
+/// `flush()` takes the queued diagnostics and emits them to another logger in a deterministic
+/// order, regardless of the order in which the parsing threads logged them.
+/// \notes As the diagnostics are delayed until `flush()`,
+/// they will be emitted after the exception thrown for a critical diagnostic.
+class buffered_diagnostic_logger final : public diagnostic_logger
+{
+public:
+    /// \effects Creates it giving it the logger the diagnostics are emitted to.
+    /// It is verbose if the target logger is verbose.
+    explicit buffered_diagnostic_logger(type_safe::object_ref<const diagnostic_logger> target);
+
+    /// \effects Flushes the remaining diagnostics.
+    /// If the target logger throws, the remaining diagnostics are discarded.
+    ~buffered_diagnostic_logger() noexcept override;
+
+    /// \effects Emits all diagnostics logged so far to the target logger and removes them.
+    /// The diagnostics are grouped by file, with the files in lexicographical order
+    /// and the diagnostics without a file first.
+    /// The diagnostics of a file are ordered by line, column, severity and message.
+    /// \returns The number of diagnostics that were emitted.
+    /// \notes This function is thread safe, but should be called once all parsing threads are
+    /// finished, as diagnostics logged concurrently might be emitted by the next call.
+    std::size_t flush();
+
+    /// \returns A reference to the logger the diagnostics are emitted to.
+    const diagnostic_logger& target() const noexcept
+    {
+        return *target_;
+    }
+
+private:
+    struct entry
+    {
+        const char* source;
+        diagnostic  diag;
+    };
+
+    struct node;
+
+    bool do_log(const char* source, const diagnostic& d) const override;
+
+    // moves the queued diagnostics into the buffer, mutex_ must be locked
+    void drain();
+
+    type_safe::object_ref<const diagnostic_logger> target_;
+    mutable std::atomic<node*>                     queue_;
+
+    std::mutex                                mutex_;
+    std::map<std::string, std::vector<entry>> buffer_;
+};
+} // namespace cppast
+
+#endif // CPPAST_BUFFERED_DIAGNOSTIC_LOGGER_HPP_INCLUDED
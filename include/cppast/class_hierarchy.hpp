@@ -0,0 +1,106 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_CLASS_HIERARCHY_HPP_INCLUDED
+#define CPPAST_CLASS_HIERARCHY_HPP_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include <type_safe/reference.hpp>
+
+#include <cppast/cppast_fwd.hpp>
+
+namespace cppast
+{
+/// The inheritance graph of all class definitions in a [cppast::cpp_entity_index]().
+///
+/// The base classes are resolved once while building it, unwrapping typedefs and alias templates
+/// like [cppast::get_class]().
+/// The transitive closures of the base and derived classes are stored as one bit per class,
+/// so checking whether a class is derived from another one is a constant time operation,
+/// and getting all (transitive) base or derived classes is linear in the number of classes.
+///
+/// \notes It is a snapshot of the index, files registered after it was built aren't part of it.
+class class_hierarchy
+{
+public:
+    /// \effects Builds the hierarchy of all class definitions in all files registered in the
+    /// index.
+    /// Base classes that don't resolve to a class definition in the index, e.g. because they
+    /// depend on a template parameter, are ignored.
+    explicit class_hierarchy(const cpp_entity_index& idx);
+
+    /// \returns The number of classes.
+    std::size_t size() const noexcept
+    {
+        return classes_.size();
+    }
+
+    /// \returns All classes in a topological order, i.e. every class comes after its base classes.
+    const std::vector<type_safe::object_ref<const cpp_class>>& classes() const noexcept
+    {
+        return classes_;
+    }
+
+    /// \returns Whether or not the class is part of the hierarchy.
+    bool contains(const cpp_class& c) const noexcept;
+
+    /// \returns The classes the class directly inherits from, in declaration order.
+    /// \requires The class must be part of the hierarchy.
+    std::vector<type_safe::object_ref<const cpp_class>> direct_bases(const cpp_class& c) const;
+
+    /// \returns The classes that directly inherit from the class.
+    /// \requires The class must be part of the hierarchy.
+    std::vector<type_safe::object_ref<const cpp_class>> direct_derived_classes(
+        const cpp_class& c) const;
+
+    /// \returns The direct and indirect base classes of the class, in topological order.
+    /// \requires The class must be part of the hierarchy.
+    std::vector<type_safe::object_ref<const cpp_class>> bases(const cpp_class& c) const;
+
+    /// \returns The direct and indirect derived classes of the class, in topological order.
+    /// \requires The class must be part of the hierarchy.
+    std::vector<type_safe::object_ref<const cpp_class>> derived_classes(const cpp_class& c) const;
+
+    /// \returns Whether or not `derived` directly or indirectly inherits from `base`.
+    /// A class is not derived from itself.
+    /// \notes It returns `false` if one of the classes isn't part of the hierarchy.
+    bool is_derived_from(const cpp_class& derived, const cpp_class& base) const noexcept;
+
+private:
+    using word_type                     = std::uint_least64_t;
+    static constexpr unsigned word_bits = 64u;
+
+    static constexpr std::uint_least32_t invalid_index = UINT_LEAST32_MAX;
+
+    // the index of the class in classes_, or invalid_index
+    std::uint_least32_t get_index(const cpp_class& c) const noexcept;
+    std::uint_least32_t get_checked_index(const cpp_class& c) const noexcept;
+
+    bool test(const std::vector<word_type>& closure, std::uint_least32_t row,
+              std::uint_least32_t column) const noexcept
+    {
+        return (closure[row * words_per_row_ + column / word_bits]
+                & (word_type(1u) << (column % word_bits)))
+               != 0u;
+    }
+
+    std::vector<type_safe::object_ref<const cpp_class>> get_row(
+        const std::vector<word_type>& closure, std::uint_least32_t row) const;
+    std::vector<type_safe::object_ref<const cpp_class>> get_classes(
+        const std::vector<std::uint_least32_t>& indices) const;
+
+    std::vector<type_safe::object_ref<const cpp_class>> classes_;
+    // the class index of each entity by cpp_entity::dense_index()
+    std::vector<std::uint_least32_t> class_indices_;
+
+    std::vector<std::vector<std::uint_least32_t>> direct_bases_, direct_derived_;
+
+    // the closures as matrix with one row per class
+    std::size_t            words_per_row_;
+    std::vector<word_type> bases_, derived_;
+};
+} // namespace cppast
+
+#endif // CPPAST_CLASS_HIERARCHY_HPP_INCLUDED
@@ -5,6 +5,10 @@
 #define CPPAST_CODE_GENERATOR_HPP_INCLUDED
 
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <type_safe/flag_set.hpp>
 #include <type_safe/index.hpp>
@@ -135,6 +139,40 @@ enum class formatting_flags
 /// A set of formatting flags.
 using formatting = type_safe::flag_set<formatting_flags>;
 
+/// \exclude
+namespace detail
+{
+    // the buffer of a buffered_code_generator, the output writes directly into it
+    struct code_generator_buffer
+    {
+        std::string str;
+        unsigned    indent_width;
+        unsigned    indent      = 0u;
+        bool        was_newline = false;
+
+        explicit code_generator_buffer(unsigned width) noexcept : indent_width(width) {}
+
+        void write(const string_view& tokens)
+        {
+            if (was_newline)
+            {
+                str.append(indent * indent_width, ' ');
+                was_newline = false;
+            }
+            str.append(tokens.c_str(), tokens.length());
+        }
+
+        void newline()
+        {
+            str += '\n';
+            was_newline = true;
+        }
+    };
+
+    class edit_generator;
+    struct parallel_generation;
+} // namespace detail
+
 /// Base class to control the code generation.
 ///
 /// Inherit from it to customize how a [cppast::cpp_entity]() is printed
@@ -165,6 +203,9 @@ public:
     using generation_options = type_safe::flag_set<generation_flags>;
 
     /// Sentinel type used to output a given entity.
+    ///
+    /// For a [cppast::buffered_code_generator]() the tokens are appended to its buffer directly,
+    /// instead of calling the `do_write_XXX()` functions and `do_indent()`/`do_unindent()`.
     class output
     {
     public:
@@ -235,15 +276,30 @@ public:
         /// `true`).
         void indent(bool print_newline = true) const noexcept
         {
-            gen_->do_indent();
-            if (print_newline)
-                gen_->do_write_newline();
+            if (auto buffer = gen_->buffer_)
+            {
+                ++buffer->indent;
+                if (print_newline)
+                    buffer->newline();
+            }
+            else
+            {
+                gen_->do_indent();
+                if (print_newline)
+                    gen_->do_write_newline();
+            }
         }
 
         /// \effects Calls `do_unindent()`.
         void unindent() const noexcept
         {
-            gen_->do_unindent();
+            if (auto buffer = gen_->buffer_)
+            {
+                if (buffer->indent != 0u)
+                    --buffer->indent;
+            }
+            else
+                gen_->do_unindent();
         }
 
         /// \effects Calls `func(*this)`.
@@ -256,22 +312,36 @@ public:
         /// \effects Calls `do_write_keyword()`.
         const output& operator<<(const keyword& k) const
         {
-            gen_->do_write_keyword(k.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(k.str());
+            else
+                gen_->do_write_keyword(k.str());
             return *this;
         }
 
         /// \effects Calls `do_write_identifier()`.
         const output& operator<<(const identifier& ident) const
         {
-            gen_->do_write_identifier(ident.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(ident.str());
+            else
+                gen_->do_write_identifier(ident.str());
             return *this;
         }
 
         /// \effects Calls `do_write_reference()`.
+        /// For a [cppast::buffered_code_generator]() it writes the name of the reference instead,
+        /// so the reference is never excluded.
         template <typename T, class Predicate>
         const output& operator<<(const basic_cpp_entity_ref<T, Predicate>& ref) const
         {
-            was_excluded_ = !gen_->do_write_reference(ref.id(), ref.name());
+            if (auto buffer = gen_->buffer_)
+            {
+                buffer->write(ref.name());
+                was_excluded_ = false;
+            }
+            else
+                was_excluded_ = !gen_->do_write_reference(ref.id(), ref.name());
             return *this;
         }
 
@@ -284,49 +354,70 @@ public:
         /// \effects Calls `do_write_punctuation()`.
         const output& operator<<(const punctuation& punct) const
         {
-            gen_->do_write_punctuation(punct.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(punct.str());
+            else
+                gen_->do_write_punctuation(punct.str());
             return *this;
         }
 
         /// \effects Calls `do_write_str_literal`.
         const output& operator<<(const string_literal& lit) const
         {
-            gen_->do_write_str_literal(lit.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(lit.str());
+            else
+                gen_->do_write_str_literal(lit.str());
             return *this;
         }
 
         /// \effects Calls `do_write_int_literal()`.
         const output& operator<<(const int_literal& lit) const
         {
-            gen_->do_write_int_literal(lit.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(lit.str());
+            else
+                gen_->do_write_int_literal(lit.str());
             return *this;
         }
 
         /// \effects Calls `do_write_float_literal()`.
         const output& operator<<(const float_literal& lit) const
         {
-            gen_->do_write_float_literal(lit.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(lit.str());
+            else
+                gen_->do_write_float_literal(lit.str());
             return *this;
         }
 
         /// \effects Calls `do_write_preprocessor()`.
         const output& operator<<(const preprocessor_token& tok) const
         {
-            gen_->do_write_preprocessor(tok.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(tok.str());
+            else
+                gen_->do_write_preprocessor(tok.str());
             return *this;
         }
 
         /// \effects Calls `do_write_comment()`.
         const output& operator<<(const comment& c) const
         {
-            gen_->do_write_comment(c.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(c.str());
+            else
+                gen_->do_write_comment(c.str());
             return *this;
         }
 
         /// \effects Calls `do_write_token_seq()`.
         const output& operator<<(const token_seq& seq) const
         {
-            gen_->do_write_token_seq(seq.str());
+            if (auto buffer = gen_->buffer_)
+                buffer->write(seq.str());
+            else
+                gen_->do_write_token_seq(seq.str());
             return *this;
         }
 
@@ -340,14 +431,20 @@ public:
         /// \effects Calls `do_write_newline()`.
         const output& operator<<(newl_t) const
         {
-            gen_->do_write_newline();
+            if (auto buffer = gen_->buffer_)
+                buffer->newline();
+            else
+                gen_->do_write_newline();
             return *this;
         }
 
         /// \effects Calls `do_write_whitespace()`.
         const output& operator<<(whitespace_t) const
         {
-            gen_->do_write_whitespace();
+            if (auto buffer = gen_->buffer_)
+                buffer->write(" ");
+            else
+                gen_->do_write_whitespace();
             return *this;
         }
 
@@ -507,8 +604,137 @@ private:
     }
 
     type_safe::optional_ref<const cpp_entity> main_entity_;
+    // non-null for a buffered_code_generator
+    detail::code_generator_buffer*            buffer_ = nullptr;
 
     friend bool generate_code(code_generator& generator, const cpp_entity& e);
+    friend class buffered_code_generator;
+    friend detail::edit_generator;
+    friend detail::parallel_generation;
+};
+
+/// A [cppast::code_generator]() that writes the code into a contiguous string buffer.
+///
+/// The tokens are appended to the buffer directly by the [cppast::code_generator::output](),
+/// without a virtual call per token.
+/// All functions that write tokens or change the indentation are `final`;
+/// derived classes can still customize the formatting, the generation options,
+/// the excluded entities and the `on_XXX()` functions.
+/// \notes References are written as their name without calling `do_write_reference()`,
+/// so they can't be excluded and [cppast::code_generator::output::was_reference_excluded]() is
+/// always `false`.
+class buffered_code_generator : public code_generator
+{
+public:
+    /// \effects Creates it with an empty buffer,
+    /// using `indent_width` spaces per indentation level.
+    explicit buffered_code_generator(unsigned indent_width = 4u) : storage_(indent_width)
+    {
+        buffer_ = &storage_;
+    }
+
+    /// \returns The code generated so far.
+    const std::string& str() const noexcept
+    {
+        return storage_.str;
+    }
+
+    /// \returns The code generated so far, leaving the buffer empty.
+    std::string release() noexcept
+    {
+        auto result = std::move(storage_.str);
+        clear();
+        return result;
+    }
+
+    /// \effects Reserves memory for `size` characters in the buffer.
+    void reserve(std::size_t size)
+    {
+        storage_.str.reserve(size);
+    }
+
+    /// \effects Clears the buffer and resets the indentation.
+    void clear() noexcept
+    {
+        storage_.str.clear();
+        storage_.indent      = 0u;
+        storage_.was_newline = false;
+    }
+
+private:
+    void do_indent() final
+    {
+        ++storage_.indent;
+    }
+
+    void do_unindent() final
+    {
+        if (storage_.indent != 0u)
+            --storage_.indent;
+    }
+
+    void do_write_token_seq(string_view tokens) final
+    {
+        storage_.write(tokens);
+    }
+
+    void do_write_keyword(string_view keyword) final
+    {
+        storage_.write(keyword);
+    }
+
+    void do_write_identifier(string_view identifier) final
+    {
+        storage_.write(identifier);
+    }
+
+    bool do_write_reference(type_safe::array_ref<const cpp_entity_id>, string_view name) final
+    {
+        storage_.write(name);
+        return true;
+    }
+
+    void do_write_punctuation(string_view punct) final
+    {
+        storage_.write(punct);
+    }
+
+    void do_write_str_literal(string_view str) final
+    {
+        storage_.write(str);
+    }
+
+    void do_write_int_literal(string_view str) final
+    {
+        storage_.write(str);
+    }
+
+    void do_write_float_literal(string_view str) final
+    {
+        storage_.write(str);
+    }
+
+    void do_write_preprocessor(string_view punct) final
+    {
+        storage_.write(punct);
+    }
+
+    void do_write_comment(string_view c) final
+    {
+        storage_.write(c);
+    }
+
+    void do_write_newline() final
+    {
+        storage_.newline();
+    }
+
+    void do_write_whitespace() final
+    {
+        storage_.write(" ");
+    }
+
+    detail::code_generator_buffer storage_;
 };
 
 /// Generates code for the given entity.
@@ -518,6 +744,58 @@ private:
 /// \returns Whether or not any code was actually written.
 bool generate_code(code_generator& generator, const cpp_entity& e);
 
+/// Generates code for the file as modified by the edit.
+///
+/// It behaves like generating the original file,
+/// except that replaced entities are generated instead of the original ones,
+/// removed entities are skipped and inserted entities are generated next to the original ones.
+/// The main entity is the original file.
+///
+/// \notes The generator is driven through an internal adapter that resolves the children through
+/// the edit and forwards everything else to the generator,
+/// so the `output` passed to the `on_XXX()` functions refers to the adapter.
+/// Code generated with the generator itself, e.g. by its `generate_code()` member function,
+/// doesn't see the edit.
+///
+/// \returns Whether or not any code was actually written.
+bool generate_code(code_generator& generator, const cpp_file_edit& edit);
+
+/// A function that creates a new [cppast::buffered_code_generator]().
+/// \notes It is called concurrently by multiple threads.
+using buffered_code_generator_factory = std::function<std::unique_ptr<buffered_code_generator>()>;
+
+/// Generates code for multiple entities in parallel.
+///
+/// Each entity is generated by a new generator created by the factory,
+/// just like calling [cppast::generate_code]() with it,
+/// so the entity is the main entity and the formatting, generation options and `on_XXX()`
+/// functions are used as usual.
+/// The entities are distributed over up to `thread_count` threads,
+/// or one per hardware thread if it is `0`.
+///
+/// \returns The code of each entity, in the order of the entities.
+/// This is everything written by the generator,
+/// including the code written by the `on_XXX()` functions for an entity that is `custom`.
+/// \throws Any exception thrown while generating the code, after all threads have finished.
+std::vector<std::string> generate_code_parallel(
+    const buffered_code_generator_factory&                      factory,
+    const std::vector<type_safe::object_ref<const cpp_entity>>& entities,
+    unsigned                                                    thread_count = 0u);
+
+/// Generates code for the file, generating its top-level entities in parallel.
+///
+/// The code of the top-level entities is generated like by the other overload of
+/// [cppast::generate_code_parallel]() and then concatenated in order,
+/// separated by newlines like [cppast::generate_code]() separates them.
+/// Like there, entities that are excluded by the generation options aren't generated at all,
+/// and no separator is written after an entity that is `custom`.
+///
+/// \returns The code of the file.
+/// \notes Unlike [cppast::generate_code](), the `on_XXX()` functions aren't called for the file
+/// itself and every top-level entity is the main entity of its generator.
+std::string generate_code_parallel(const buffered_code_generator_factory& factory,
+                                   const cpp_file& file, unsigned thread_count = 0u);
+
 /// \exclude
 namespace detail
 {
@@ -5,6 +5,7 @@
 #define CPPAST_CPP_ENTITY_HPP_INCLUDED
 
 #include <atomic>
+#include <cstdint>
 #include <string>
 
 #include <type_safe/optional_ref.hpp>
@@ -15,6 +16,19 @@
 
 namespace cppast
 {
+/// \exclude
+namespace detail
+{
+    struct cpp_doc_comment_access;
+    struct cpp_structural_hash_access;
+    struct cpp_dense_index_access;
+    struct cpp_name_cache;
+    struct cpp_name_cache_access;
+} // namespace detail
+
+/// The value of [cppast::cpp_entity::dense_index]() for an entity that isn't part of a registered
+/// [cppast::cpp_file]().
+constexpr std::uint_least32_t invalid_dense_index = UINT_LEAST32_MAX;
 
 /// The name of a scope.
 ///
@@ -50,7 +64,7 @@ public:
     cpp_entity(const cpp_entity&) = delete;
     cpp_entity& operator=(const cpp_entity&) = delete;
 
-    virtual ~cpp_entity() noexcept = default;
+    virtual ~cpp_entity() noexcept;
 
     /// \returns The kind of the entity.
     cpp_entity_kind kind() const noexcept
@@ -78,6 +92,20 @@ public:
         return parent_;
     }
 
+    /// \returns The dense index of the entity.
+    /// When a [cppast::cpp_file]() is registered in a [cppast::cpp_entity_index](),
+    /// the file and all entities in it are numbered sequentially, continuing after the entities
+    /// of the files registered before. The index can then be used to store per-entity data in a
+    /// [cppast::side_table]() or an [cppast::entity_bitset]().
+    /// If the entity isn't part of a registered file, it returns
+    /// [cppast::invalid_dense_index]().
+    /// \notes The number belongs to the single index the file was registered in,
+    /// a file can't be numbered by multiple indices.
+    std::uint_least32_t dense_index() const noexcept
+    {
+        return dense_index_.load(std::memory_order_relaxed);
+    }
+
     /// \returns The documentation comment associated with that entity, if any.
     /// \notes A documentation comment can have three forms:
     ///
@@ -103,16 +131,18 @@ public:
     /// on the same line as the end of line comment.
     ///
     /// This comment system is also used by [standardese](https://standardese.foonathan.net).
-    type_safe::optional_ref<const std::string> comment() const noexcept
-    {
-        return comment_.empty() ? nullptr : type_safe::opt_ref(&comment_);
-    }
+    ///
+    /// Comments of parsed entities are stored in the [cppast::cpp_doc_comment_table]() of the file,
+    /// the text is only created on the first call to this function, which allocates.
+    /// An empty documentation comment is matched, but it is not returned.
+    type_safe::optional_ref<const std::string> comment() const;
 
     /// \effects Sets the associated comment.
     /// \requires The comment must not be empty, if there is one.
     void set_comment(type_safe::optional<std::string> comment) noexcept
     {
-        comment_ = comment.value_or("");
+        comment_       = comment.value_or("");
+        comment_index_ = 0u;
     }
 
     /// \returns The list of attributes that are specified for that entity.
@@ -152,7 +182,14 @@ public:
     }
 
     /// \effects Creates it giving it the the name.
-    cpp_entity(std::string name) : name_(std::move(name)), user_data_(nullptr) {}
+    cpp_entity(std::string name)
+    : name_(std::move(name)),
+      user_data_(nullptr),
+      structural_hash_(0u),
+      comment_index_(0u),
+      dense_index_(invalid_dense_index),
+      name_cache_(nullptr)
+    {}
 
 private:
     /// \returns The kind of the entity.
@@ -170,17 +207,48 @@ private:
         parent_ = type_safe::ref(parent);
     }
 
-    std::string                               name_;
-    std::string                               comment_;
-    cpp_attribute_list                        attributes_;
-    type_safe::optional_ref<const cpp_entity> parent_;
-    mutable std::atomic<void*>                user_data_;
+    std::string                                  name_;
+    std::string                                  comment_;
+    cpp_attribute_list                           attributes_;
+    type_safe::optional_ref<const cpp_entity>    parent_;
+    mutable std::atomic<void*>                   user_data_;
+    // cached result of structural_hash(), 0 if not computed yet
+    mutable std::atomic<std::uint_least64_t>     structural_hash_;
+    // index + 1 into the comment table of the file, 0 if there is none
+    std::uint_least32_t                          comment_index_;
+    // assigned by the index when the file is registered
+    mutable std::atomic<std::uint_least32_t>     dense_index_;
+    // cached result of qualified_name() and scope_path(), nullptr if not computed yet
+    mutable std::atomic<detail::cpp_name_cache*> name_cache_;
 
     template <typename T>
     friend struct detail::intrusive_list_access;
     friend detail::intrusive_list_node<cpp_entity>;
+    friend detail::cpp_doc_comment_access;
+    friend detail::cpp_structural_hash_access;
+    friend detail::cpp_dense_index_access;
+    friend detail::cpp_name_cache_access;
 };
 
+/// \exclude
+namespace detail
+{
+    // used by the parser to associate an entity with a comment of the file's comment table
+    struct cpp_doc_comment_access
+    {
+        static std::uint_least32_t get(const cpp_entity& e) noexcept
+        {
+            return e.comment_index_;
+        }
+
+        static void set(cpp_entity& e, std::uint_least32_t index) noexcept
+        {
+            e.comment_.clear();
+            e.comment_index_ = index;
+        }
+    };
+} // namespace detail
+
 /// A [cppast::cpp_entity]() that isn't exposed directly.
 ///
 /// The only information available is the raw source code.
@@ -223,6 +291,26 @@ bool is_templated(const cpp_entity& e) noexcept;
 /// \returns Whether or not the given entity is "friended",
 /// that is, its declaration exists as part of a [cppast::cpp_friend]() declaration.
 bool is_friended(const cpp_entity& e) noexcept;
+
+/// \returns The names of all scopes enclosing the entity, each followed by `::`,
+/// e.g. `a::b::` for an entity declared in `namespace a { struct b { ... }; }`,
+/// or an empty string for an entity in the global scope.
+/// Anonymous scopes don't contribute to it,
+/// and a template and its templated entity are a single scope.
+/// \notes The result is computed once per scope and stored in the scope entity,
+/// so it is shared by all of its children.
+/// The AST must not be modified afterwards.
+/// \notes This operation is thread safe.
+const std::string& scope_path(const cpp_entity& e);
+
+/// \returns The fully qualified name of the entity, e.g. `a::b::c`,
+/// i.e. the concatenation of [cppast::scope_path](), the semantic scope and the name.
+/// The semantic scope is only non-empty for out of line definitions,
+/// so for `void a::f() {}` at global scope the scope path is empty but the result is `a::f`.
+/// \notes The result is computed once and stored in the entity.
+/// The AST must not be modified afterwards.
+/// \notes This operation is thread safe.
+const std::string& qualified_name(const cpp_entity& e);
 } // namespace cppast
 
 #endif // CPPAST_CPP_ENTITY_HPP_INCLUDED
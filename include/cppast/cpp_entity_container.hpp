@@ -4,6 +4,14 @@
 #ifndef CPPAST_CPP_ENTITY_CONTAINER_HPP_INCLUDED
 #define CPPAST_CPP_ENTITY_CONTAINER_HPP_INCLUDED
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <type_safe/reference.hpp>
+
 #include <cppast/cpp_entity.hpp>
 
 namespace cppast
@@ -29,11 +37,31 @@ public:
         return children_.end();
     }
 
+    /// \returns A [ts::array_ref]() of all children with the given name in declaration order,
+    /// e.g. all overloads of a function.
+    /// If there is no child with that name, it returns an empty array reference.
+    /// \notes The first call builds a table of the children by name,
+    /// so later calls don't need to walk the children.
+    /// \notes This operation is thread safe.
+    type_safe::array_ref<const type_safe::object_ref<const T>> find_members(
+        const std::string& name) const
+    {
+        auto& table = get_member_table();
+        auto  iter  = table.find(name);
+        if (iter == table.end())
+            return nullptr;
+        return type_safe::ref(iter->second.data(), iter->second.size());
+    }
+
 protected:
+    cpp_entity_container() noexcept : member_table_(nullptr) {}
+
     /// \effects Adds a new child to the container.
     void add_child(std::unique_ptr<T> ptr) noexcept
     {
         children_.push_back(static_cast<Derived&>(*this), std::move(ptr));
+        // the table is outdated, building the container isn't concurrent with lookups
+        delete member_table_.exchange(nullptr, std::memory_order_relaxed);
     }
 
     /// \returns A non-const iterator to the first child.
@@ -48,10 +76,35 @@ protected:
         return children_.begin();
     }
 
-    ~cpp_entity_container() noexcept = default;
+    ~cpp_entity_container() noexcept
+    {
+        delete member_table_.load(std::memory_order_relaxed);
+    }
 
 private:
-    detail::intrusive_list<T> children_;
+    using member_table
+        = std::unordered_map<std::string, std::vector<type_safe::object_ref<const T>>>;
+
+    const member_table& get_member_table() const
+    {
+        if (auto table = member_table_.load(std::memory_order_acquire))
+            return *table;
+
+        std::unique_ptr<member_table> table(new member_table());
+        for (auto& child : children_)
+            (*table)[child.name()].push_back(type_safe::ref(child));
+
+        // if another thread was faster, use its table instead
+        member_table* expected = nullptr;
+        if (!member_table_.compare_exchange_strong(expected, table.get(),
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire))
+            return *expected;
+        return *table.release();
+    }
+
+    detail::intrusive_list<T>          children_;
+    mutable std::atomic<member_table*> member_table_;
 };
 } // namespace cppast
 
@@ -4,8 +4,12 @@
 #ifndef CPPAST_CPP_ENTITY_INDEX_HPP_INCLUDED
 #define CPPAST_CPP_ENTITY_INDEX_HPP_INCLUDED
 
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -15,46 +19,137 @@
 #include <type_safe/strong_typedef.hpp>
 
 #include <cppast/cppast_fwd.hpp>
+#include <cppast/detail/shared_mutex.hpp>
+#include <cppast/qualified_name_index.hpp>
 
 namespace cppast
 {
 /// \exclude
 namespace detail
 {
-    using hash_type               = std::uint_least64_t;
-    constexpr hash_type fnv_basis = 14695981039346656037ull;
-    constexpr hash_type fnv_prime = 1099511628211ull;
+    using hash_type = std::uint_least64_t;
 
-    // FNV-1a 64 bit hash
-    constexpr hash_type id_hash(const char* str, hash_type hash = fnv_basis)
+    // a block based hash in the style of wyhash,
+    // everything is constexpr so ids of string literals can be computed at compile time
+    constexpr hash_type hash_secret0 = 0xa0761d6478bd642full;
+    constexpr hash_type hash_secret1 = 0xe7037ed1a0b428dbull;
+    constexpr hash_type hash_secret2 = 0x8ebc6af09c88c6e3ull;
+    constexpr hash_type hash_low     = 0xffffffffull;
+
+    // folds the 128 bit product of a and b into 64 bit, computed from the 32 bit halves
+    constexpr hash_type hash_mum_fold(hash_type ll, hash_type lh, hash_type hl, hash_type hh,
+                                      hash_type mid)
+    {
+        return ((ll & hash_low) | (mid << 32u))
+               ^ (hh + (lh >> 32u) + (hl >> 32u) + (mid >> 32u));
+    }
+
+    constexpr hash_type hash_mum_mid(hash_type ll, hash_type lh, hash_type hl, hash_type hh)
     {
-        return *str ? id_hash(str + 1, (hash ^ hash_type(*str)) * fnv_prime) : hash;
+        return hash_mum_fold(ll, lh, hl, hh, (ll >> 32u) + (lh & hash_low) + (hl & hash_low));
     }
+
+    constexpr hash_type hash_mum(hash_type a, hash_type b)
+    {
+        return hash_mum_mid((a & hash_low) * (b & hash_low), (a & hash_low) * (b >> 32u),
+                            (a >> 32u) * (b & hash_low), (a >> 32u) * (b >> 32u));
+    }
+
+    // reads up to 8 bytes as little endian integer
+    constexpr hash_type hash_read(const char* str, std::size_t length)
+    {
+        return length == 0u
+                   ? 0u
+                   : (hash_type(static_cast<unsigned char>(str[length - 1u])) << (8u * (length - 1u)))
+                         | hash_read(str, length - 1u);
+    }
+
+    // hashes 16 byte blocks, the last block may be shorter
+    constexpr hash_type hash_blocks(const char* str, std::size_t length, hash_type seed)
+    {
+        return length > 16u
+                   ? hash_blocks(str + 16u, length - 16u,
+                                 hash_mum(hash_read(str, 8u) ^ hash_secret1,
+                                          hash_read(str + 8u, 8u) ^ seed))
+                   : hash_mum(hash_read(str, length < 8u ? length : 8u) ^ hash_secret1,
+                              (length > 8u ? hash_read(str + 8u, length - 8u) : 0u) ^ seed);
+    }
+
+    constexpr hash_type id_hash(const char* str, std::size_t length)
+    {
+        return hash_mum(hash_blocks(str, length, hash_secret0 ^ hash_type(length)) ^ hash_secret2,
+                        hash_type(length) ^ hash_secret1);
+    }
+
+    // hashes the string, and records it in the index verifying the ids of the thread, if any
+    hash_type checked_id_hash(const char* str, std::size_t length);
+
+    // records the string under the given hash in the index,
+    // so collisions can be tested without two strings that actually collide
+    void verify_id_hash(const cpp_entity_index& idx, hash_type hash, const char* str,
+                        std::size_t length);
 } // namespace detail
 
+/// Exception thrown if two different strings have the same [cppast::cpp_entity_id](),
+/// only if id verification is enabled in the [cppast::cpp_entity_index]().
+class cpp_entity_id_collision_error : public std::logic_error
+{
+public:
+    cpp_entity_id_collision_error(const std::string& first, const std::string& second);
+};
+
 /// A [ts::strong_typedef]() representing the unique id of a [cppast::cpp_entity]().
 ///
-/// It is comparable for equality.
+/// It is a 64 bit hash of the string that identifies the entity, and comparable for equality.
 struct cpp_entity_id : type_safe::strong_typedef<cpp_entity_id, detail::hash_type>,
                        type_safe::strong_typedef_op::equality_comparison<cpp_entity_id>
 {
-    explicit cpp_entity_id(const std::string& str) : cpp_entity_id(str.c_str()) {}
+    explicit cpp_entity_id(const std::string& str)
+    : strong_typedef(detail::checked_id_hash(str.c_str(), str.size()))
+    {}
 
-    explicit cpp_entity_id(const char* str) : strong_typedef(detail::id_hash(str)) {}
+    explicit cpp_entity_id(const char* str)
+    : strong_typedef(detail::checked_id_hash(str, std::strlen(str)))
+    {}
+
+    /// \effects Creates it from the first `length` characters of the string.
+    /// \notes Unlike the other constructors, it is `constexpr` and never checks for collisions,
+    /// use the `_id` literal to check string literals on lookup.
+    constexpr cpp_entity_id(const char* str, std::size_t length)
+    : strong_typedef(detail::id_hash(str, length))
+    {}
+};
+
+/// The [cppast::cpp_entity_id]() created by the `_id` literal.
+///
+/// It remembers the string literal,
+/// so lookups with it can be checked for collisions by the [cppast::cpp_entity_index]().
+struct cpp_entity_id_literal : cpp_entity_id
+{
+    const char* string;
+    std::size_t length;
+
+    constexpr cpp_entity_id_literal(const char* str, std::size_t size)
+    : cpp_entity_id(str, size), string(str), length(size)
+    {}
 };
 
 inline namespace literals
 {
     /// \returns A new [cppast::cpp_entity_id]() created from the given string.
-    inline cpp_entity_id operator"" _id(const char* str, std::size_t)
+    constexpr cpp_entity_id_literal operator"" _id(const char* str, std::size_t length)
     {
-        return cpp_entity_id(str);
+        return cpp_entity_id_literal(str, length);
     }
 } // namespace literals
 
 /// An index of all [cppast::cpp_entity]() objects created.
 ///
 /// It maps [cppast::cpp_entity_id]() to references to the [cppast::cpp_entity]() objects.
+/// The entities are partitioned by their id into independently locked shards,
+/// and lookups only take a shared lock, so parallel parsing and analysis doesn't contend on a
+/// single lock.
+/// Once everything is registered, the index can be frozen into flat tables for lock-free lookups.
 class cpp_entity_index
 {
 public:
@@ -65,9 +160,81 @@ public:
         duplicate_definition_error();
     };
 
+    /// Exception thrown when registering an entity in a frozen index.
+    class frozen_index_error : public std::logic_error
+    {
+    public:
+        frozen_index_error();
+    };
+
+    /// Buffers the registrations of the current thread.
+    ///
+    /// While it is alive, all registrations of entities and namespaces in the index from the
+    /// thread that created it are appended to the batch instead of being registered immediately.
+    /// They are registered by [cppast::cpp_entity_index::register_batch](), which takes the lock of
+    /// each shard only once. Once committed, the batch stops buffering and later registrations are
+    /// registered immediately. Registrations that weren't committed are discarded when the batch is
+    /// destroyed.
+    /// \notes Files are always registered immediately.
+    class registration_batch
+    {
+    public:
+        /// \effects Starts buffering the registrations of the current thread in the index.
+        explicit registration_batch(const cpp_entity_index& idx) noexcept;
+
+        registration_batch(const registration_batch&) = delete;
+        registration_batch& operator=(const registration_batch&) = delete;
+
+        /// \effects Stops buffering and discards the registrations that weren't committed.
+        ~registration_batch() noexcept;
+
+        /// \returns The number of buffered registrations.
+        std::size_t size() const noexcept
+        {
+            return entries_.size();
+        }
+
+        /// \returns Whether or not the batch has been committed,
+        /// i.e. doesn't buffer registrations anymore.
+        bool is_committed() const noexcept
+        {
+            return committed_;
+        }
+
+    private:
+        enum class entry_kind
+        {
+            definition,
+            declaration,
+            namespace_,
+        };
+
+        struct entry
+        {
+            cpp_entity_id     id;
+            const cpp_entity* entity;
+            entry_kind        kind;
+
+            entry(cpp_entity_id id, const cpp_entity* entity, entry_kind kind)
+            : id(std::move(id)), entity(entity), kind(kind)
+            {}
+        };
+
+        const cpp_entity_index* idx_;
+        registration_batch*     previous_;
+        std::vector<entry>      entries_;
+        bool                    committed_;
+
+        friend cpp_entity_index;
+    };
+
+    /// \effects Creates an empty index.
+    cpp_entity_index() noexcept : frozen_(false) {}
+
     /// \effects Registers a new [cppast::cpp_entity]() which is a definition.
     /// It will override any previously registered declarations of the same entity.
-    /// \throws duplicate_defintion_error if the entity has been registered as definition before.
+    /// \throws duplicate_defintion_error if the entity has been registered as definition before,
+    /// frozen_index_error if the index is frozen.
     /// \requires The entity must live as long as the index lives,
     /// and it must not be a namespace.
     /// \notes This operation is thread safe.
@@ -75,14 +242,19 @@ public:
                              type_safe::object_ref<const cpp_entity> entity) const;
 
     /// \effects Registers a new [cppast::cpp_file]().
+    /// The file and all entities in it are given the next [cppast::cpp_entity::dense_index]().
     /// \returns `true` if the file was not registered before.
     /// If it returns `false`, the file was registered before and nothing was changed.
-    /// \requires The entity must live as long as the index lives.
+    /// \throws frozen_index_error if the index is frozen.
+    /// \requires The entity must live as long as the index lives,
+    /// and it must not be registered in a different index,
+    /// as the dense indices are stored in the entities themselves.
     /// \notes This operation is thread safe.
     bool register_file(cpp_entity_id id, type_safe::object_ref<const cpp_file> file) const;
 
     /// \effects Registers a new [cppast::cpp_entity]() which is a declaration.
     /// Only the first declaration will be registered.
+    /// \throws frozen_index_error if the index is frozen.
     /// \requires The entity must live as long as the index lives.
     /// \requires The entity must be forward declarable.
     /// \notes This operation is thread safe.
@@ -90,6 +262,7 @@ public:
                                       type_safe::object_ref<const cpp_entity> entity) const;
 
     /// \effects Registers a new [cppast::cpp_namespace]().
+    /// \throws frozen_index_error if the index is frozen.
     /// \notes The namespace object must live as long as the index lives.
     /// \notes This operation is thread safe.
     void register_namespace(cpp_entity_id id, type_safe::object_ref<const cpp_namespace> ns) const;
@@ -100,18 +273,129 @@ public:
     /// optional. \notes This operation is thread safe.
     type_safe::optional_ref<const cpp_entity> lookup(const cpp_entity_id& id) const noexcept;
 
+    /// \effects Verifies the id if id verification is enabled.
+    /// \returns The result of the lookup with the id.
+    /// \throws cpp_entity_id_collision_error if the literal has the same id as a different string.
+    type_safe::optional_ref<const cpp_entity> lookup(const cpp_entity_id_literal& id) const
+    {
+        verify_literal(id);
+        return lookup(static_cast<const cpp_entity_id&>(id));
+    }
+
+    /// \effects Registers all entities and namespaces buffered in the batch, in order,
+    /// taking the lock of each shard only once, clears the batch and marks it as committed.
+    /// \throws duplicate_defintion_error if an entity has been registered as definition before,
+    /// frozen_index_error if the index is frozen.
+    /// If it throws, nothing of the batch has been registered and the batch is unchanged.
+    /// \requires The batch must have been created for this index and must not have been committed.
+    /// \notes This operation is thread safe.
+    void register_batch(registration_batch& batch) const;
+
     /// \returns A [ts::optional_ref]() corresponding to the entity of the given
     /// [cppast::cpp_entity_id](). If no definition has been registered, it returns an empty
     /// optional. \notes This operation is thread safe.
     type_safe::optional_ref<const cpp_entity> lookup_definition(
         const cpp_entity_id& id) const noexcept;
 
+    /// \effects Verifies the id if id verification is enabled.
+    /// \returns The result of the lookup with the id.
+    /// \throws cpp_entity_id_collision_error if the literal has the same id as a different string.
+    type_safe::optional_ref<const cpp_entity> lookup_definition(
+        const cpp_entity_id_literal& id) const
+    {
+        verify_literal(id);
+        return lookup_definition(static_cast<const cpp_entity_id&>(id));
+    }
+
+    /// \returns The result of [cppast::cpp_entity_index::lookup]() for each of the ids,
+    /// in the same order.
+    /// The lock of each shard is only taken once.
+    /// \notes This operation is thread safe.
+    std::vector<type_safe::optional_ref<const cpp_entity>> lookup_many(
+        type_safe::array_ref<const cpp_entity_id> ids) const;
+
     /// \returns A [ts::array_ref]() of references to all namespaces matching the given
     /// [cppast::cpp_entity_id](). If no namespace is found, it returns an empty array reference.
     /// \notes This operation is thread safe.
     auto lookup_namespace(const cpp_entity_id& id) const noexcept
         -> type_safe::array_ref<type_safe::object_ref<const cpp_namespace>>;
 
+    /// \effects Verifies the id if id verification is enabled.
+    /// \returns The result of the lookup with the id.
+    /// \throws cpp_entity_id_collision_error if the literal has the same id as a different string.
+    auto lookup_namespace(const cpp_entity_id_literal& id) const
+        -> type_safe::array_ref<type_safe::object_ref<const cpp_namespace>>
+    {
+        verify_literal(id);
+        return lookup_namespace(static_cast<const cpp_entity_id&>(id));
+    }
+
+    /// \returns The number of dense indices assigned so far,
+    /// i.e. one more than the biggest [cppast::cpp_entity::dense_index]().
+    /// \notes This operation is thread safe.
+    std::uint_least32_t dense_index_count() const noexcept;
+
+    /// \returns A [ts::optional_ref]() to the entity with the given
+    /// [cppast::cpp_entity::dense_index](), or an empty optional if there is none.
+    /// \notes This operation is thread safe.
+    type_safe::optional_ref<const cpp_entity> lookup_dense_index(
+        std::uint_least32_t index) const noexcept;
+
+    /// \effects Compacts the index into flat open-addressed tables.
+    /// Afterwards, lookups don't take any locks and don't allocate,
+    /// and any further registration throws [cppast::cpp_entity_index::frozen_index_error]().
+    /// References returned by earlier lookups stay valid.
+    /// Freezing a frozen index has no effect.
+    /// \requires No other operation on the index may run concurrently.
+    void freeze();
+
+    /// \returns Whether or not the index is frozen.
+    bool is_frozen() const noexcept
+    {
+        return frozen_.load(std::memory_order_acquire);
+    }
+
+    /// \effects Enables the [cppast::qualified_name_index]() of the index,
+    /// all files registered afterwards are added to it.
+    /// Enabling it again has no effect.
+    /// \requires No other operation on the index may run concurrently.
+    void enable_qualified_name_index();
+
+    /// \effects Enables the verification of ids, which is disabled by default.
+    /// The index then remembers the string of every id created at runtime in an
+    /// [cppast::cpp_entity_index::id_verification]() of it, and of every `_id` literal it is
+    /// looked up with. Two different strings with the same id throw
+    /// [cppast::cpp_entity_id_collision_error]() instead of silently aliasing the entities.
+    /// Lookups with `_id` literals take a lock even if the index is frozen.
+    /// Enabling it again has no effect.
+    /// \requires No other operation on the index may run concurrently.
+    void enable_id_verification();
+
+    /// Verifies the ids created on the current thread while it is alive.
+    ///
+    /// The parser creates one while it parses a file into the index,
+    /// it has no effect if id verification isn't enabled.
+    /// They must be destroyed in the reverse order of creation.
+    class id_verification
+    {
+    public:
+        explicit id_verification(const cpp_entity_index& idx) noexcept;
+        ~id_verification() noexcept;
+
+        id_verification(const id_verification&) = delete;
+        id_verification& operator=(const id_verification&) = delete;
+
+    private:
+        const cpp_entity_index* previous_;
+    };
+
+    /// \returns A [ts::optional_ref]() to the [cppast::qualified_name_index]() of the index,
+    /// or an empty optional if it wasn't enabled.
+    type_safe::optional_ref<const qualified_name_index> qualified_names() const noexcept
+    {
+        return type_safe::opt_cref(names_.get());
+    }
+
 private:
     struct hash
     {
@@ -131,11 +415,88 @@ private:
         {}
     };
 
-    mutable std::mutex                                     mutex_;
-    mutable std::unordered_map<cpp_entity_id, value, hash> map_;
-    mutable std::unordered_map<cpp_entity_id,
-                               std::vector<type_safe::object_ref<const cpp_namespace>>, hash>
-        ns_;
+    // the entities are partitioned by id into shards that are locked independently
+    struct shard
+    {
+        detail::shared_mutex                           mutex;
+        std::unordered_map<cpp_entity_id, value, hash> map;
+        std::unordered_map<cpp_entity_id, std::vector<type_safe::object_ref<const cpp_namespace>>,
+                           hash>
+            ns;
+    };
+
+    static constexpr unsigned shard_bits = 4u;
+
+    static std::size_t get_shard_index(const cpp_entity_id& id) noexcept
+    {
+        // use the upper bits, the lower ones select the bucket of the map
+        return std::size_t(static_cast<detail::hash_type>(id) >> (64u - shard_bits));
+    }
+
+    shard& get_shard(const cpp_entity_id& id) const noexcept
+    {
+        return shards_[get_shard_index(id)];
+    }
+
+    registration_batch* get_batch() const noexcept;
+
+    // the strings of all ids seen while id verification is enabled
+    struct id_strings
+    {
+        std::mutex                                         mutex;
+        std::unordered_map<detail::hash_type, std::string> strings;
+    };
+
+    void verify_id(detail::hash_type hash, const char* str, std::size_t length) const;
+    void verify_literal(const cpp_entity_id_literal& id) const
+    {
+        if (id_strings_)
+            verify_id(static_cast<detail::hash_type>(id), id.string, id.length);
+    }
+
+    friend detail::hash_type detail::checked_id_hash(const char* str, std::size_t length);
+    friend void detail::verify_id_hash(const cpp_entity_index& idx, detail::hash_type hash,
+                                       const char* str, std::size_t length);
+
+    static void insert_definition(shard& s, cpp_entity_id id,
+                                  type_safe::object_ref<const cpp_entity> entity);
+    static void insert_declaration(shard& s, cpp_entity_id id,
+                                   type_safe::object_ref<const cpp_entity> entity);
+    static void insert_namespace(shard& s, cpp_entity_id id,
+                                 type_safe::object_ref<const cpp_namespace> ns);
+
+    mutable shard shards_[std::size_t(1u) << shard_bits];
+
+    mutable std::mutex dense_mutex_;
+    // entity with dense index i is dense_[i]
+    mutable std::vector<const cpp_entity*> dense_;
+
+    // the tables of a frozen index, using linear probing with a power of two size
+    struct frozen_entity
+    {
+        detail::hash_type id;
+        const cpp_entity* entity; // nullptr if the slot is empty
+        bool              is_definition;
+    };
+
+    // points to the vector in the shard, which is kept alive,
+    // so references returned before freezing stay valid
+    struct frozen_namespace
+    {
+        detail::hash_type                                 id;
+        const type_safe::object_ref<const cpp_namespace>* begin;
+        std::size_t                                       size; // 0 if the slot is empty
+    };
+
+    const frozen_entity*    lookup_frozen(const cpp_entity_id& id) const noexcept;
+    const frozen_namespace* lookup_frozen_namespace(const cpp_entity_id& id) const noexcept;
+
+    std::vector<frozen_entity>    frozen_map_;
+    std::vector<frozen_namespace> frozen_ns_;
+    std::atomic<bool>             frozen_;
+
+    std::unique_ptr<qualified_name_index> names_;
+    std::unique_ptr<id_strings>           id_strings_;
 };
 } // namespace cppast
 
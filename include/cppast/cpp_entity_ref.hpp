@@ -92,16 +92,13 @@ private:
     void get_impl(std::false_type, std::vector<type_safe::object_ref<const T>>& result,
                   const cpp_entity_index& idx) const
     {
-        for (auto& cur : id())
-        {
-            auto entity = idx.lookup(cur).map([](const cpp_entity& e) {
-                DEBUG_ASSERT(Predicate{}(e), detail::precondition_error_handler{},
-                             "invalid entity type");
-                return type_safe::ref(static_cast<const T&>(e));
-            });
+        for (auto& entity : idx.lookup_many(id()))
             if (entity)
-                result.push_back(type_safe::ref(entity.value()));
-        }
+            {
+                DEBUG_ASSERT(Predicate{}(entity.value()), detail::precondition_error_handler{},
+                             "invalid entity type");
+                result.push_back(type_safe::ref(static_cast<const T&>(entity.value())));
+            }
     }
 
     type_safe::variant<cpp_entity_id, std::vector<cpp_entity_id>> target_;
@@ -4,6 +4,9 @@
 #ifndef CPPAST_CPP_FILE_HPP_INCLUDED
 #define CPPAST_CPP_FILE_HPP_INCLUDED
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include <cppast/cpp_entity_container.hpp>
@@ -21,6 +24,69 @@ struct cpp_doc_comment
     cpp_doc_comment(std::string content, unsigned line) : content(std::move(content)), line(line) {}
 };
 
+/// The documentation comments of a [cppast::cpp_file]().
+///
+/// The text of all comments is stored in a single buffer.
+/// Entities only refer to their comment by index,
+/// the `std::string` returned by [cppast::cpp_entity::comment]() is created on demand.
+class cpp_doc_comment_table
+{
+public:
+    /// A comment in the table.
+    struct entry
+    {
+        std::uint_least32_t offset, size; // location of the text in the buffer
+        unsigned            line;
+
+        entry(std::uint_least32_t offset, std::uint_least32_t size, unsigned line)
+        : offset(offset), size(size), line(line)
+        {}
+    };
+
+    /// \effects Creates an empty table.
+    cpp_doc_comment_table() noexcept = default;
+
+    /// \effects Creates it from the buffer containing the text of all comments
+    /// and the entries referring to it.
+    /// \requires The entries must be sorted by line.
+    cpp_doc_comment_table(std::string buffer, std::vector<entry> entries);
+
+    cpp_doc_comment_table(cpp_doc_comment_table&& other) noexcept = default;
+
+    ~cpp_doc_comment_table() noexcept;
+
+    cpp_doc_comment_table& operator=(cpp_doc_comment_table&& other) noexcept;
+
+    /// \returns The number of comments in the table.
+    std::size_t size() const noexcept
+    {
+        return entries_.size();
+    }
+
+    /// \returns The entry of the comment with the given index.
+    /// \requires `index < size()`.
+    const entry& operator[](std::size_t index) const noexcept
+    {
+        return entries_[index];
+    }
+
+    /// \returns The text of the comment with the given index.
+    /// It is created on the first call and cached afterwards.
+    /// \requires `index < size()`.
+    /// \notes This operation is thread safe.
+    const std::string& text(std::size_t index) const;
+
+    /// \returns The text of the first comment ending on the given line,
+    /// or an empty optional, if there is none.
+    /// \notes This does a binary search over the entries.
+    type_safe::optional_ref<const std::string> lookup(unsigned line) const;
+
+private:
+    std::string                                         buffer_;
+    std::vector<entry>                                  entries_;
+    std::unique_ptr<std::atomic<const std::string*>[]> cache_;
+};
+
 /// A [cppast::cpp_entity]() modelling a file.
 ///
 /// This is the top-level entity of the AST.
@@ -48,6 +114,13 @@ public:
             file_->comments_.push_back(std::move(comment));
         }
 
+        /// \effects Sets the table of the comments,
+        /// matched entities refer to it by index.
+        void set_comment_table(cpp_doc_comment_table table) noexcept
+        {
+            file_->comment_table_ = std::move(table);
+        }
+
         /// \returns The not yet finished file.
         cpp_file& get() noexcept
         {
@@ -73,6 +146,12 @@ public:
         return type_safe::ref(comments_.data(), comments_.size());
     }
 
+    /// \returns The table of all documentation comments of the file.
+    const cpp_doc_comment_table& comment_table() const noexcept
+    {
+        return comment_table_;
+    }
+
 private:
     cpp_file(std::string name) : cpp_entity(std::move(name)) {}
 
@@ -80,6 +159,7 @@ private:
     cpp_entity_kind do_get_entity_kind() const noexcept override;
 
     std::vector<cpp_doc_comment> comments_;
+    cpp_doc_comment_table        comment_table_;
 };
 
 /// \exclude
@@ -0,0 +1,139 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_CPP_FILE_EDIT_HPP_INCLUDED
+#define CPPAST_CPP_FILE_EDIT_HPP_INCLUDED
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <type_safe/optional_ref.hpp>
+#include <type_safe/reference.hpp>
+
+#include <cppast/cpp_file.hpp>
+
+namespace cppast
+{
+/// A set of modifications to a parsed [cppast::cpp_file]().
+///
+/// The parsed entities are immutable and own their children,
+/// so a modified file can't share the unchanged entities with the original.
+/// Instead, the edit refers to the original file and only stores the modifications:
+/// entities can be replaced by new ones, removed, or new entities can be inserted next to them.
+/// Creating an edit and modifying it doesn't copy any entities of the file.
+///
+/// The modified file can be generated using [cppast::generate_code]().
+/// \notes The result is not a [cppast::cpp_file]():
+/// the modifications only exist for the code generation.
+/// Everything else, e.g. the [cppast::cpp_entity_index](), [cppast::visit]() or
+/// [cppast::cpp_entity::parent](), only sees the original file.
+/// In particular, the new entities are not registered in the index,
+/// and their parent is the parent of the original entity, which doesn't contain them.
+/// \notes Only entities of the original file can be modified.
+/// The children of new entities are generated as they are,
+/// the edit can't modify them.
+class cpp_file_edit
+{
+public:
+    /// \effects Creates an edit of the given file without any modifications.
+    explicit cpp_file_edit(const cpp_file& file) : file_(type_safe::ref(file)) {}
+
+    cpp_file_edit(cpp_file_edit&&) = default;
+    cpp_file_edit& operator=(cpp_file_edit&&) = default;
+
+    /// \returns The file that is being edited.
+    const cpp_file& original() const noexcept
+    {
+        return *file_;
+    }
+
+    /// \effects Replaces the entity by the given one.
+    /// The new entity gets the same parent as the old one.
+    /// If the entity was removed before, it is now replaced.
+    /// \requires `entity` must be an entity of the original file other than the file itself.
+    /// \returns A reference to the edit.
+    cpp_file_edit& replace(const cpp_entity& entity, std::unique_ptr<cpp_entity> replacement);
+
+    /// \effects Removes the entity and all its children.
+    /// Entities inserted before or after it are not removed.
+    /// \requires `entity` must be an entity of the original file other than the file itself.
+    /// \returns A reference to the edit.
+    cpp_file_edit& remove(const cpp_entity& entity);
+
+    /// \effects Inserts the new entity directly before the given one,
+    /// i.e. after all other entities inserted before it.
+    /// The new entity gets the same parent as the given one.
+    /// \requires `entity` must be an entity of the original file other than the file itself.
+    /// \returns A reference to the edit.
+    cpp_file_edit& insert_before(const cpp_entity&           entity,
+                                 std::unique_ptr<cpp_entity> new_entity);
+
+    /// \effects Inserts the new entity directly after the given one,
+    /// i.e. after all other entities inserted after it.
+    /// The new entity gets the same parent as the given one.
+    /// \requires `entity` must be an entity of the original file other than the file itself.
+    /// \returns A reference to the edit.
+    cpp_file_edit& insert_after(const cpp_entity&           entity,
+                                std::unique_ptr<cpp_entity> new_entity);
+
+    /// \returns The entity that takes the place of the given one in the modified file:
+    /// its replacement, the entity itself if it wasn't replaced,
+    /// or an empty optional if it was removed.
+    type_safe::optional_ref<const cpp_entity> lookup(const cpp_entity& entity) const noexcept;
+
+    /// \returns The entities inserted before the given one, in order.
+    std::vector<type_safe::object_ref<const cpp_entity>> inserted_before(
+        const cpp_entity& entity) const;
+
+    /// \returns The entities inserted after the given one, in order.
+    std::vector<type_safe::object_ref<const cpp_entity>> inserted_after(
+        const cpp_entity& entity) const;
+
+    /// \returns Whether or not the given entity was modified,
+    /// i.e. replaced, removed, or had entities inserted next to it.
+    bool is_modified(const cpp_entity& entity) const noexcept
+    {
+        return changes_.count(&entity) != 0u;
+    }
+
+    /// \returns The number of modified entities.
+    std::size_t size() const noexcept
+    {
+        return changes_.size();
+    }
+
+    /// \returns Whether or not there are no modifications.
+    bool empty() const noexcept
+    {
+        return changes_.empty();
+    }
+
+private:
+    struct change
+    {
+        std::unique_ptr<cpp_entity>              replacement;
+        std::vector<std::unique_ptr<cpp_entity>> before, after;
+        bool                                     removed = false;
+    };
+
+    change& get_change(const cpp_entity& entity);
+
+    const change* find_change(const cpp_entity& entity) const noexcept
+    {
+        auto iter = changes_.find(&entity);
+        return iter == changes_.end() ? nullptr : &iter->second;
+    }
+
+    type_safe::object_ref<const cpp_file>         file_;
+    std::unordered_map<const cpp_entity*, change> changes_;
+};
+
+/// \returns An edit of the given file without any modifications.
+inline cpp_file_edit edit(const cpp_file& file)
+{
+    return cpp_file_edit(file);
+}
+} // namespace cppast
+
+#endif // CPPAST_CPP_FILE_EDIT_HPP_INCLUDED
@@ -85,6 +85,10 @@ private:
 /// \returns Whether or not the given entity is a definition.
 bool is_definition(const cpp_entity& e) noexcept;
 
+/// \returns The [cppast::cpp_forward_declarable::semantic_scope]() of the given entity,
+/// or the empty string if it isn't forward declarable.
+std::string semantic_scope(const cpp_entity& e);
+
 /// Gets the definition of an entity.
 /// \returns A [ts::optional_ref]() to the entity that is the definition.
 /// If the entity is a definition or not derived from [cppast::cpp_forward_declarable]() (only valid
@@ -5,6 +5,7 @@
 #define CPPAST_CPP_TYPE_HPP_INCLUDED
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 
 #include <cppast/code_generator.hpp>
@@ -13,6 +14,12 @@
 
 namespace cppast
 {
+/// \exclude
+namespace detail
+{
+    struct cpp_structural_hash_access;
+} // namespace detail
+
 /// The kinds of a [cppast::cpp_type]().
 enum class cpp_type_kind
 {
@@ -74,7 +81,7 @@ public:
     }
 
 protected:
-    cpp_type() noexcept : user_data_(nullptr) {}
+    cpp_type() noexcept : user_data_(nullptr), structural_hash_(0u) {}
 
 private:
     /// \returns The [cppast::cpp_type_kind]().
@@ -82,11 +89,14 @@ private:
 
     void on_insert(const cpp_type&) {}
 
-    mutable std::atomic<void*> user_data_;
+    mutable std::atomic<void*>               user_data_;
+    // cached result of structural_hash(), 0 if not computed yet
+    mutable std::atomic<std::uint_least64_t> structural_hash_;
 
     template <typename T>
     friend struct detail::intrusive_list_access;
     friend detail::intrusive_list_node<cpp_type>;
+    friend detail::cpp_structural_hash_access;
 };
 
 /// An unexposed [cppast::cpp_type]().
@@ -0,0 +1,94 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_CPP_TYPE_PRINTER_HPP_INCLUDED
+#define CPPAST_CPP_TYPE_PRINTER_HPP_INCLUDED
+
+#include <string>
+#include <unordered_map>
+
+#include <cppast/code_generator.hpp>
+#include <cppast/cpp_type.hpp>
+
+namespace cppast
+{
+/// Writes the string representation of [cppast::cpp_type]() objects.
+///
+/// It writes the same string as [cppast::detail::write_type]() with the default formatting
+/// and a generator that doesn't exclude any references,
+/// but directly appends the tokens to a string instead of going through a
+/// [cppast::code_generator]().
+class cpp_type_printer
+{
+public:
+    /// A function that can substitute the tokens of the type, e.g. template parameters by
+    /// arguments.
+    ///
+    /// It is called with the user data and every token that is written.
+    /// \returns A pointer to the string that should be written instead,
+    /// or `nullptr` to write the token itself.
+    using substitution = const std::string* (*)(void* user_data, string_view token);
+
+    /// A function that is called for every reference to an entity that is written,
+    /// e.g. the class of a user-defined type.
+    ///
+    /// It is called with the user data, the ids of the target and the name,
+    /// before the name is written.
+    using reference_callback = void (*)(void*                                     user_data,
+                                        type_safe::array_ref<const cpp_entity_id> ids,
+                                        string_view                               name);
+
+    /// \effects Creates a printer without substitution.
+    /// If `use_cache` is `true`, it stores the string of every type passed to `write()` and
+    /// `print()`, and reuses it when the same type object is printed again.
+    explicit cpp_type_printer(bool use_cache = false)
+    : substitution_(nullptr), user_data_(nullptr), use_cache_(use_cache)
+    {}
+
+    /// \effects Creates a printer that substitutes the tokens using the given function.
+    cpp_type_printer(substitution subst, void* user_data, bool use_cache = false)
+    : substitution_(subst), user_data_(user_data), use_cache_(use_cache)
+    {}
+
+    /// \effects Sets the function that is called for every reference,
+    /// `nullptr` removes it.
+    /// \notes While a function is set, the cache isn't used,
+    /// so the function is called for all references of every type.
+    void set_reference_callback(reference_callback callback, void* user_data) noexcept
+    {
+        reference_callback_ = callback;
+        reference_data_     = user_data;
+    }
+
+    /// \effects Appends the string representation of the type to the buffer.
+    /// \notes If the cache is used, the type object must not be destroyed while the printer is
+    /// used, or the cache cleared before.
+    void write(std::string& buffer, const cpp_type& type);
+
+    /// \returns The string representation of the type.
+    std::string print(const cpp_type& type)
+    {
+        std::string result;
+        write(result, type);
+        return result;
+    }
+
+    /// \effects Removes all types from the cache.
+    void clear_cache() noexcept
+    {
+        cache_.clear();
+    }
+
+private:
+    void write_uncached(std::string& buffer, const cpp_type& type);
+
+    substitution                                     substitution_;
+    void*                                            user_data_;
+    reference_callback                               reference_callback_ = nullptr;
+    void*                                            reference_data_     = nullptr;
+    std::unordered_map<const cpp_type*, std::string> cache_;
+    bool                                             use_cache_;
+};
+} // namespace cppast
+
+#endif // CPPAST_CPP_TYPE_PRINTER_HPP_INCLUDED
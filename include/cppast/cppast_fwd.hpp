@@ -33,6 +33,7 @@ class cpp_enum;
 class cpp_enum_value;
 class cpp_expression;
 class cpp_file;
+class cpp_file_edit;
 class cpp_forward_declarable;
 class cpp_friend;
 class cpp_function;
@@ -0,0 +1,92 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_DETAIL_SHARED_MUTEX_HPP_INCLUDED
+#define CPPAST_DETAIL_SHARED_MUTEX_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace cppast
+{
+namespace detail
+{
+    // a reader-writer lock for short critical sections, std::shared_mutex requires C++17
+    // readers only do a single atomic increment if there is no writer,
+    // writers are serialized by a mutex and wait until all readers are done
+    class shared_mutex
+    {
+    public:
+        shared_mutex() noexcept : state_(0u) {}
+
+        shared_mutex(const shared_mutex&) = delete;
+        shared_mutex& operator=(const shared_mutex&) = delete;
+
+        void lock()
+        {
+            writer_mutex_.lock();
+            // no new readers after this
+            state_.fetch_or(writer_bit, std::memory_order_acquire);
+            while ((state_.load(std::memory_order_acquire) & ~writer_bit) != 0u)
+                std::this_thread::yield();
+        }
+
+        void unlock() noexcept
+        {
+            state_.fetch_and(~writer_bit, std::memory_order_release);
+            writer_mutex_.unlock();
+        }
+
+        void lock_shared() noexcept
+        {
+            while (true)
+            {
+                if ((state_.fetch_add(1u, std::memory_order_acquire) & writer_bit) == 0u)
+                    return;
+
+                // writer active, back off until it is done
+                state_.fetch_sub(1u, std::memory_order_relaxed);
+                while ((state_.load(std::memory_order_relaxed) & writer_bit) != 0u)
+                    std::this_thread::yield();
+            }
+        }
+
+        void unlock_shared() noexcept
+        {
+            state_.fetch_sub(1u, std::memory_order_release);
+        }
+
+    private:
+        static constexpr std::uint_least32_t writer_bit = std::uint_least32_t(1u) << 31u;
+
+        // writer bit and the number of readers
+        std::atomic<std::uint_least32_t> state_;
+        std::mutex                       writer_mutex_;
+    };
+
+    // std::shared_lock requires C++14
+    class shared_lock
+    {
+    public:
+        explicit shared_lock(shared_mutex& mutex) noexcept : mutex_(&mutex)
+        {
+            mutex_->lock_shared();
+        }
+
+        shared_lock(const shared_lock&) = delete;
+        shared_lock& operator=(const shared_lock&) = delete;
+
+        ~shared_lock() noexcept
+        {
+            mutex_->unlock_shared();
+        }
+
+    private:
+        shared_mutex* mutex_;
+    };
+} // namespace detail
+} // namespace cppast
+
+#endif // CPPAST_DETAIL_SHARED_MUTEX_HPP_INCLUDED
@@ -4,7 +4,12 @@
 #ifndef CPPAST_LIBCLANG_PARSER_HPP_INCLUDED
 #define CPPAST_LIBCLANG_PARSER_HPP_INCLUDED
 
+#include <cstdint>
+#include <memory>
 #include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <cppast/parser.hpp>
 
@@ -83,6 +88,8 @@ private:
                                       void* user_data, void (*callback)(void*, std::string));
 };
 
+class json_compilation_database;
+
 /// Compilation config for the [cppast::libclang_parser]().
 class libclang_compile_config final : public compile_config
 {
@@ -109,6 +116,13 @@ public:
     /// path.
     libclang_compile_config(const libclang_compilation_database& database, const std::string& file);
 
+    /// Creates the configuration stored in the database.
+    ///
+    /// \effects Same as the other overload, but uses the [cppast::json_compilation_database]().
+    /// It only copies the default configuration and adds the flags stored for the file.
+    /// \throws `libclang_error` if the database does not contain the file.
+    libclang_compile_config(const json_compilation_database& database, const std::string& file);
+
     libclang_compile_config(const libclang_compile_config& other) = default;
     libclang_compile_config& operator=(const libclang_compile_config& other) = default;
 
@@ -174,6 +188,101 @@ private:
     friend detail::libclang_compile_config_access;
 };
 
+/// A shared, immutable snapshot of a [cppast::libclang_compile_config]().
+///
+/// Copying it only copies a pointer, so it can be passed to every file without copying the flags.
+/// It also stores the arguments passed to libclang and a fingerprint of the configuration,
+/// so they aren't recomputed every time a file is parsed.
+class libclang_shared_config
+{
+public:
+    /// \effects Creates a snapshot of the given configuration.
+    explicit libclang_shared_config(libclang_compile_config config);
+
+    /// \returns A handle to a snapshot of the given configuration.
+    /// If a handle to an equal configuration still exists, the snapshot is shared with it.
+    /// \notes This function is thread safe.
+    static libclang_shared_config intern(const libclang_compile_config& config);
+
+    /// \returns The configuration.
+    const libclang_compile_config& config() const noexcept;
+
+    /// \returns The arguments that are passed to libclang when parsing a file.
+    /// \notes The pointers are valid as long as a handle to the snapshot exists.
+    const std::vector<const char*>& arguments() const noexcept;
+
+    /// \returns A hash of the clang binary, the flags and the other options of the configuration.
+    /// \notes It only depends on the configuration, not on the process,
+    /// so it can be used as key of caches that are stored on disk.
+    std::uint_least64_t fingerprint() const noexcept;
+
+    /// \returns Whether or not both handles refer to equal configurations.
+    friend bool operator==(const libclang_shared_config& a,
+                           const libclang_shared_config& b) noexcept;
+
+    friend bool operator!=(const libclang_shared_config& a,
+                           const libclang_shared_config& b) noexcept
+    {
+        return !(a == b);
+    }
+
+private:
+    struct data;
+
+    explicit libclang_shared_config(std::shared_ptr<const data> d) : data_(std::move(d)) {}
+
+    std::shared_ptr<const data> data_;
+};
+
+/// A compilation database that reads the `compile_commands.json` file itself.
+///
+/// It provides the same configurations as [cppast::libclang_compilation_database](),
+/// but the file is parsed only once when the database is created:
+/// The flags used by the configuration are extracted from each command and stored by file name,
+/// and each distinct flag is only stored once as most of them are shared by all files.
+/// The default configuration is also only created once,
+/// so creating the configuration of a file doesn't need to query the database or run `clang`.
+/// \notes Like libclang, it only finds files given with their full path,
+/// but `.` and `..` components are allowed.
+/// Unlike libclang, it doesn't guess a configuration for files that aren't in the database.
+class json_compilation_database
+{
+public:
+    /// \effects Creates it giving the directory where the `compile_commands.json` file is located.
+    /// \throws `libclang_error` if the database could not be loaded or parsed.
+    explicit json_compilation_database(const std::string& build_directory);
+
+    json_compilation_database(json_compilation_database&&) = default;
+    json_compilation_database& operator=(json_compilation_database&&) = default;
+
+    /// \returns Whether or not the database contains information about the given file.
+    /// \group has_config
+    bool has_config(const char* file_name) const;
+
+    /// \group has_config
+    bool has_config(const std::string& file_name) const
+    {
+        return has_config(file_name.c_str());
+    }
+
+    /// \returns The full paths of the files in the order of the commands in the database.
+    const std::vector<std::string>& files() const noexcept
+    {
+        return files_;
+    }
+
+private:
+    const std::vector<const std::string*>* find(const char* file_name) const;
+
+    libclang_compile_config         default_config_;
+    std::unordered_set<std::string> strings_;
+    // flags of the file, pointing into strings_
+    std::unordered_map<std::string, std::vector<const std::string*>> commands_;
+    std::vector<std::string>                                         files_;
+
+    friend libclang_compile_config;
+};
+
 /// Finds a configuration for a given file.
 ///
 /// \returns If the database contains a configuration for the given file, returns that
@@ -182,14 +291,20 @@ private:
 ///
 /// \notes This function is intended to be used as the basis for a `get_config` function of
 /// [cppast::parse_files](standardese://cppast::parse_files_basic/).
+/// \group find_config_for
 type_safe::optional<libclang_compile_config> find_config_for(
     const libclang_compilation_database& database, std::string file_name);
 
+/// \group find_config_for
+type_safe::optional<libclang_compile_config> find_config_for(
+    const json_compilation_database& database, std::string file_name);
+
 /// A parser that uses libclang.
 class libclang_parser final : public parser
 {
 public:
-    using config = libclang_compile_config;
+    using config        = libclang_compile_config;
+    using shared_config = libclang_shared_config;
 
     /// The version of libclang used.
     static int libclang_minor_version();
@@ -202,10 +317,43 @@ public:
 
     ~libclang_parser() noexcept override;
 
+    using parser::parse;
+
+    /// \effects Parses the given file like [cppast::parser::parse](),
+    /// but uses the precomputed arguments of the shared configuration.
+    std::unique_ptr<cpp_file> parse(const cpp_entity_index& idx, std::string path,
+                                    const libclang_shared_config& config) const;
+
+    /// \effects Parses multiple files like calling `parse()` for each of them,
+    /// but overlaps the stages of parsing different files:
+    /// While a file is parsed by libclang, the next files are preprocessed
+    /// and the entities of the previous file are converted.
+    /// The preprocessing and parsing run in their own thread, with at most `queue_size` files
+    /// waiting for the next stage, and the conversion in the calling thread.
+    /// \returns The parsed files in the order of the paths,
+    /// a file is `nullptr` if there was an error like for `parse()`.
+    /// \throws Any other exception thrown while parsing a file, after the stages were stopped.
+    std::vector<std::unique_ptr<cpp_file>> parse_pipelined(
+        const cpp_entity_index& idx, const std::vector<std::string>& paths,
+        const libclang_shared_config& config, std::size_t queue_size = 2u) const;
+
+    /// \effects Same as the other overload, but creates a shared snapshot of the configuration
+    /// first.
+    std::vector<std::unique_ptr<cpp_file>> parse_pipelined(
+        const cpp_entity_index& idx, const std::vector<std::string>& paths, const config& c,
+        std::size_t queue_size = 2u) const
+    {
+        return parse_pipelined(idx, paths, libclang_shared_config(c), queue_size);
+    }
+
 private:
     std::unique_ptr<cpp_file> do_parse(const cpp_entity_index& idx, std::string path,
                                        const compile_config& config) const override;
 
+    std::unique_ptr<cpp_file> parse_impl(const cpp_entity_index& idx, const std::string& path,
+                                         const libclang_compile_config&  config,
+                                         const std::vector<const char*>& args) const;
+
     struct impl;
     std::unique_ptr<impl> pimpl_;
 };
@@ -234,6 +382,23 @@ void parse_files(FileParser& parser, Range&& file_names,
     });
 }
 
+/// Parses multiple files using a [cppast::libclang_parser]() and a
+/// [cppast::json_compilation_database]().
+///
+/// \effects Same as the other overload, but uses the configurations of the given database.
+template <class FileParser, class Range>
+void parse_files(FileParser& parser, Range&& file_names, const json_compilation_database& database)
+{
+    static_assert(std::is_same<typename FileParser::parser, libclang_parser>::value,
+                  "must use the libclang parser");
+    parse_files(parser, std::forward<Range>(file_names), [&](const std::string& file) {
+        auto config = find_config_for(database, file);
+        if (!config)
+            throw libclang_error("unable to find configuration for file '" + file + "'");
+        return config.value();
+    });
+}
+
 /// Parses the files specified in a compilation database using a [cppast::libclang_parser]().
 ///
 /// \effects For each file specified in a compilation database,
@@ -259,6 +424,19 @@ void parse_database(FileParser& parser, const libclang_compilation_database& dat
         data.parser.parse(std::move(file), std::move(config));
     });
 }
+
+/// Parses the files specified in a [cppast::json_compilation_database]() using a
+/// [cppast::libclang_parser]().
+///
+/// \effects Same as the other overload, but uses the configurations of the given database.
+template <class FileParser>
+void parse_database(FileParser& parser, const json_compilation_database& database)
+{
+    static_assert(std::is_same<typename FileParser::parser, libclang_parser>::value,
+                  "must use the libclang parser");
+    for (auto& file : database.files())
+        parser.parse(file, libclang_compile_config(database, file));
+}
 } // namespace cppast
 
 #endif // CPPAST_LIBCLANG_PARSER_HPP_INCLUDED
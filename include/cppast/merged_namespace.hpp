@@ -0,0 +1,163 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_MERGED_NAMESPACE_HPP_INCLUDED
+#define CPPAST_MERGED_NAMESPACE_HPP_INCLUDED
+
+#include <atomic>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <type_safe/reference.hpp>
+
+#include <cppast/cpp_entity_index.hpp>
+#include <cppast/cpp_namespace.hpp>
+
+namespace cppast
+{
+/// A view of all [cppast::cpp_namespace]() entities of the same namespace.
+///
+/// A namespace that is reopened, e.g. in multiple headers, is a separate entity each time.
+/// The view treats them as a single scope:
+/// it iterates over the children of all of them, in the order of the files,
+/// and supports looking up children by name in all of them at once.
+/// The children aren't copied.
+class merged_namespace
+{
+public:
+    /// A forward iterator over the children of all namespaces.
+    class iterator
+    {
+    public:
+        using value_type        = cpp_entity;
+        using reference         = const cpp_entity&;
+        using pointer           = const cpp_entity*;
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        iterator() noexcept : part_(nullptr), end_(nullptr) {}
+
+        reference operator*() const noexcept
+        {
+            return *cur_;
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &*cur_;
+        }
+
+        iterator& operator++() noexcept
+        {
+            ++cur_;
+            skip_empty();
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) noexcept
+        {
+            return a.part_ == b.part_ && a.cur_ == b.cur_;
+        }
+
+        friend bool operator!=(const iterator& a, const iterator& b) noexcept
+        {
+            return !(a == b);
+        }
+
+    private:
+        using part = type_safe::object_ref<const cpp_namespace>;
+
+        iterator(const part* begin, const part* end) noexcept : part_(begin), end_(end)
+        {
+            if (part_ != end_)
+            {
+                cur_ = (*part_)->begin();
+                skip_empty();
+            }
+        }
+
+        // moves to the next namespace until there is a child or the end is reached
+        void skip_empty() noexcept
+        {
+            while (cur_ == (*part_)->end())
+            {
+                if (++part_ == end_)
+                {
+                    cur_ = cpp_namespace::iterator();
+                    return;
+                }
+                cur_ = (*part_)->begin();
+            }
+        }
+
+        const part*             part_;
+        const part*             end_;
+        cpp_namespace::iterator cur_;
+
+        friend merged_namespace;
+    };
+
+    /// \effects Creates a view of all namespaces registered with the given id.
+    merged_namespace(const cpp_entity_index& idx, const cpp_entity_id& id);
+
+    /// \effects Creates a view of the given namespaces.
+    /// They are sorted in the order of the files, as given by the
+    /// [cppast::cpp_entity::dense_index]().
+    /// \requires All namespaces must be the same namespace.
+    explicit merged_namespace(std::vector<type_safe::object_ref<const cpp_namespace>> namespaces);
+
+    merged_namespace(const merged_namespace&) = delete;
+    merged_namespace& operator=(const merged_namespace&) = delete;
+
+    ~merged_namespace() noexcept;
+
+    /// \returns The name of the namespace, or the empty string if there are no namespaces.
+    const std::string& name() const noexcept;
+
+    /// \returns The namespaces in the view, in the order of the files.
+    const std::vector<type_safe::object_ref<const cpp_namespace>>& namespaces() const noexcept
+    {
+        return namespaces_;
+    }
+
+    /// \returns An iterator to the first child of the first namespace.
+    iterator begin() const noexcept
+    {
+        return iterator(namespaces_.data(), namespaces_.data() + namespaces_.size());
+    }
+
+    /// \returns An iterator one past the last child of the last namespace.
+    iterator end() const noexcept
+    {
+        auto last = namespaces_.data() + namespaces_.size();
+        return iterator(last, last);
+    }
+
+    /// \returns A [ts::array_ref]() of all children of all namespaces with the given name, in
+    /// order. If there is no child with that name, it returns an empty array reference.
+    /// \notes The first call builds a table of the children by name.
+    /// \notes This operation is thread safe.
+    type_safe::array_ref<const type_safe::object_ref<const cpp_entity>> find_members(
+        const std::string& name) const;
+
+private:
+    using member_table
+        = std::unordered_map<std::string, std::vector<type_safe::object_ref<const cpp_entity>>>;
+
+    const member_table& get_member_table() const;
+
+    std::vector<type_safe::object_ref<const cpp_namespace>> namespaces_;
+    mutable std::atomic<member_table*>                      member_table_;
+};
+} // namespace cppast
+
+#endif // CPPAST_MERGED_NAMESPACE_HPP_INCLUDED
@@ -0,0 +1,74 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_NDJSON_EXPORTER_HPP_INCLUDED
+#define CPPAST_NDJSON_EXPORTER_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <cppast/cppast_fwd.hpp>
+
+namespace cppast
+{
+/// Exports the AST as newline-delimited JSON.
+///
+/// Every entity is written as a single JSON object on its own line while the AST is visited.
+/// There is no intermediate representation, so the memory usage does not depend on the size of
+/// the AST, only on the size of the buffer and the nesting depth.
+///
+/// A record has the following members:
+/// * `id` - A number identifying the entity, unique for all records written by the exporter.
+/// * `parent` - The `id` of the parent entity, `0` for a file.
+/// * `kind` - The result of [cppast::to_string(cpp_entity_kind)]().
+/// * `name` - The name of the entity.
+/// * `access` - The [cppast::cpp_access_specifier_kind]() of a class member, only written for
+/// those.
+/// * `definition` - Whether or not the entity is a definition, as in [cppast::is_definition]().
+/// * `type` - The spelling of the type of the entity, only written if it has one,
+/// e.g. the type of a variable or the return type of a function.
+/// * `refs` - The entities referred to by the type or target of the entity,
+/// as objects with the spelled `name` and the `target` [cppast::cpp_entity_id]()(s) in hex.
+///
+/// Function and template parameters are written as children of the function or template.
+/// Templated and friended entities are not written,
+/// their children are written as children of the template or friend declaration instead.
+/// The type and the function parameters of a templated entity are written with the template.
+class ndjson_exporter
+{
+public:
+    /// \effects Creates it writing to the given stream.
+    /// Records are collected in a buffer of the given size before they are written.
+    /// \requires The stream must live as long as the exporter.
+    explicit ndjson_exporter(std::ostream& out, std::size_t buffer_size = 1024u * 1024u);
+
+    ndjson_exporter(const ndjson_exporter&) = delete;
+    ndjson_exporter& operator=(const ndjson_exporter&) = delete;
+
+    /// \effects Writes the remaining records to the stream.
+    ~ndjson_exporter() noexcept;
+
+    /// \effects Writes a record for the file and one for each entity in it.
+    void write(const cpp_file& file);
+
+    /// \effects Writes all buffered records to the stream.
+    void flush();
+
+private:
+    void write_record(const cpp_entity& e, std::uint_least64_t id, std::uint_least64_t parent,
+                      const char* access);
+    // writes the records of the parameters, which aren't visited
+    void write_parameters(const cpp_entity& e, std::uint_least64_t id);
+
+    std::ostream*                    out_;
+    std::string                      buffer_, refs_, type_;
+    std::size_t                      buffer_size_;
+    std::uint_least64_t              next_id_;
+    std::vector<std::uint_least64_t> parents_;
+};
+} // namespace cppast
+
+#endif // CPPAST_NDJSON_EXPORTER_HPP_INCLUDED
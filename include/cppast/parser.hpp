@@ -109,13 +109,20 @@ public:
     /// \returns The parsed file or an empty optional, if a fatal error occurred.
     type_safe::optional_ref<const cpp_file> parse(std::string path, const config& c)
     {
-        parser_.logger().log("simple file parser", diagnostic{"parsing file '" + path + "'",
-                                                              source_location(), severity::info});
-        auto file = parser_.parse(*idx_, std::move(path), c);
-        auto ptr  = file.get();
-        if (file)
-            files_.push_back(std::move(file));
-        return type_safe::opt_ref(ptr);
+        return parse_impl(std::move(path), c);
+    }
+
+    /// \effects Parses the given file using a configuration that is shared between files,
+    /// like a [cppast::libclang_shared_config]().
+    /// \returns The parsed file or an empty optional, if a fatal error occurred.
+    /// \notes This function does not participate in overload resolution,
+    /// unless `Parser::shared_config` exists and is the same as `SharedConfig`.
+    template <class SharedConfig, class P = Parser,
+              typename = typename std::enable_if<
+                  std::is_same<SharedConfig, typename P::shared_config>::value>::type>
+    type_safe::optional_ref<const cpp_file> parse(std::string path, const SharedConfig& c)
+    {
+        return parse_impl(std::move(path), c);
     }
 
     /// \returns The result of [cppast::parser::error]().
@@ -144,6 +151,18 @@ public:
     }
 
 private:
+    template <class Config>
+    type_safe::optional_ref<const cpp_file> parse_impl(std::string path, const Config& c)
+    {
+        parser_.logger().log("simple file parser", diagnostic{"parsing file '" + path + "'",
+                                                              source_location(), severity::info});
+        auto file = parser_.parse(*idx_, std::move(path), c);
+        auto ptr  = file.get();
+        if (file)
+            files_.push_back(std::move(file));
+        return type_safe::opt_ref(ptr);
+    }
+
     Parser                                        parser_;
     detail::intrusive_list<cpp_file>              files_;
     type_safe::object_ref<const cpp_entity_index> idx_;
@@ -169,6 +188,24 @@ namespace detail
 
     template <class Range>
     using value_type = decltype(*get_value_type_impl(member_begin{}, std::declval<Range>()));
+
+    // the shared configuration of the parser, if the FileParser can parse with it,
+    // so the configuration is only prepared once for all files
+    template <class FileParser, class Shared = typename FileParser::parser::shared_config>
+    auto share_config(FileParser&, const typename FileParser::config& config, int)
+        -> decltype(void(std::declval<FileParser&>().parse(std::string(),
+                                                           std::declval<const Shared&>())),
+                    Shared(config))
+    {
+        return Shared(config);
+    }
+
+    template <class FileParser>
+    const typename FileParser::config& share_config(FileParser&,
+                                                    const typename FileParser::config& config, long)
+    {
+        return config;
+    }
 } // namespace detail
 
 /// Parses multiple files using a given `FileParser`.
@@ -198,28 +235,35 @@ auto parse_files(FileParser& parser, Range&& file_names, const Configuration& ge
 }
 
 /// Parses multiple files using a given `FileParser` and configuration.
-/// \effects Invokes [cppast::parse_files](standardese://parse_files_basic/) passing it the parser
-/// and file names, and a function that returns the same configuration for each file.
+/// \effects Calls the `parse()` function for each path specified in the `file_names`,
+/// using the same configuration for each file.
+/// If the parser has a `shared_config` type the `FileParser` can parse with,
+/// like [cppast::libclang_shared_config](), one is created from the configuration
+/// and used for all files.
 template <class FileParser, class Range>
 void parse_files(FileParser& parser, Range&& file_names, typename FileParser::config config)
 {
-    parse_files(parser, std::forward<Range>(file_names),
-                [&](const std::string&) { return config; });
+    auto&& shared = detail::share_config(parser, config, 0);
+    for (auto&& file : std::forward<Range>(file_names))
+        parser.parse(std::forward<decltype(file)>(file), shared);
 }
 
 /// Parses all files included by `file`.
 /// \effects For each [cppast::cpp_include_directive]() in file it will parse the included file.
+/// Like `parse_files()`, the configuration is shared between the files if the parser supports it.
 template <class FileParser>
 std::size_t resolve_includes(FileParser& parser, const cpp_file& file,
                              typename FileParser::config config)
 {
+    auto&& shared = detail::share_config(parser, config, 0);
+
     auto count = 0u;
     for (auto& entity : file)
     {
         if (entity.kind() == cpp_include_directive::kind())
         {
             auto& include = static_cast<const cpp_include_directive&>(entity);
-            parser.parse(include.full_path(), config);
+            parser.parse(include.full_path(), shared);
             ++count;
         }
     }
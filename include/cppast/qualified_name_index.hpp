@@ -0,0 +1,99 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_QUALIFIED_NAME_INDEX_HPP_INCLUDED
+#define CPPAST_QUALIFIED_NAME_INDEX_HPP_INCLUDED
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <type_safe/reference.hpp>
+
+#include <cppast/cppast_fwd.hpp>
+#include <cppast/detail/shared_mutex.hpp>
+
+namespace cppast
+{
+/// An index mapping fully qualified names to [cppast::cpp_entity]() objects.
+///
+/// The qualified name of an entity is the name of the entity prefixed by the names of all
+/// enclosing scopes separated by `::`, e.g. `ns::detail::foo`, without a leading `::`.
+/// Anonymous scopes don't contribute to the name.
+/// The names are stored in a sorted string table,
+/// so exact and prefix queries only need a binary search.
+///
+/// It contains all named entities of the files except for files, access specifiers,
+/// include and using directives, using declarations, friend declarations and static assertions.
+/// A templated entity isn't added, only the template itself.
+/// Function, template and macro parameters and base classes aren't added either.
+///
+/// Use [cppast::cpp_entity_index::enable_qualified_name_index]() to build it while registering
+/// files.
+class qualified_name_index
+{
+public:
+    /// \effects Creates an empty index.
+    qualified_name_index() noexcept : dirty_(false) {}
+
+    qualified_name_index(const qualified_name_index&) = delete;
+    qualified_name_index& operator=(const qualified_name_index&) = delete;
+
+    /// \effects Adds all entities of the file.
+    /// \requires The file must live as long as the index lives.
+    /// \notes This operation is thread safe.
+    void add(const cpp_file& file);
+
+    /// \returns All entities with the given qualified name, e.g. all overloads of a function,
+    /// in the order they were added.
+    /// \notes This operation is thread safe.
+    std::vector<type_safe::object_ref<const cpp_entity>> lookup(const std::string& name) const;
+
+    /// \returns All entities whose qualified name starts with the given prefix,
+    /// ordered by name.
+    /// \notes Use a prefix like `ns::` to get everything inside the namespace `ns`.
+    /// \notes This operation is thread safe.
+    std::vector<type_safe::object_ref<const cpp_entity>> lookup_prefix(
+        const std::string& prefix) const;
+
+    /// \returns All entities whose qualified name matches the given glob pattern,
+    /// ordered by name.
+    /// In the pattern, `*` matches any sequence of characters and `?` matches a single character,
+    /// e.g. `ns::*::foo` matches `foo` in any scope nested in `ns`.
+    /// \notes Only the names starting with the part of the pattern before the first wildcard are
+    /// checked, so the search is fast as long as the pattern doesn't start with a wildcard.
+    /// \notes This operation is thread safe.
+    std::vector<type_safe::object_ref<const cpp_entity>> lookup_glob(
+        const std::string& pattern) const;
+
+    /// \returns The number of names in the index.
+    /// \notes This operation is thread safe.
+    std::size_t size() const noexcept;
+
+private:
+    struct entry
+    {
+        std::string       name;
+        const cpp_entity* entity;
+
+        entry(std::string name, const cpp_entity& e) : name(std::move(name)), entity(&e) {}
+    };
+
+    using iterator = std::vector<entry>::const_iterator;
+
+    // sorts the pending entries into the table
+    void update() const;
+
+    iterator lower_bound(const std::string& name) const noexcept;
+    iterator prefix_end(iterator begin, const std::string& prefix) const noexcept;
+
+    mutable detail::shared_mutex mutex_;
+    // sorted by name, and in insertion order for equal names
+    mutable std::vector<entry> entries_;
+    // entries added since the last query
+    mutable std::vector<entry> pending_;
+    mutable std::atomic<bool>  dirty_;
+};
+} // namespace cppast
+
+#endif // CPPAST_QUALIFIED_NAME_INDEX_HPP_INCLUDED
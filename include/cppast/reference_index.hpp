@@ -0,0 +1,108 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_REFERENCE_INDEX_HPP_INCLUDED
+#define CPPAST_REFERENCE_INDEX_HPP_INCLUDED
+
+#include <unordered_map>
+#include <vector>
+
+#include <type_safe/reference.hpp>
+
+#include <cppast/cpp_entity_index.hpp>
+#include <cppast/detail/shared_mutex.hpp>
+
+namespace cppast
+{
+/// How an entity refers to another one.
+enum class cpp_reference_role
+{
+    base,        //< A class has it as base class.
+    parameter,   //< A function has a parameter of it.
+    return_type, //< A function returns it.
+    member,      //< A member variable or bitfield has it as type.
+    variable,    //< A variable has it as type.
+    alias,       //< A type alias refers to it.
+};
+
+/// \returns A human readable string describing the role.
+const char* to_string(cpp_reference_role role) noexcept;
+
+/// An index mapping entities to the entities that refer to them.
+///
+/// The references are the [cppast::cpp_user_defined_type]() and
+/// [cppast::cpp_template_instantiation_type]() objects anywhere in the types of an entity,
+/// e.g. `std::vector<X>*` as parameter refers to both `std::vector` and `X`.
+/// They are grouped by the [cppast::cpp_reference_role]() of the type.
+/// An entity referring to a target multiple times in the same role is only stored once.
+///
+/// The index is not built by the parser, the files have to be added explicitly.
+class reference_index
+{
+public:
+    /// A reference to an entity.
+    struct reference
+    {
+        /// The referring entity.
+        /// It is the class for [cppast::cpp_reference_role::base](),
+        /// the function for [cppast::cpp_reference_role::parameter]() and
+        /// [cppast::cpp_reference_role::return_type](),
+        /// and the variable or type alias otherwise.
+        type_safe::object_ref<const cpp_entity> entity;
+        cpp_reference_role                      role;
+
+        reference(const cpp_entity& e, cpp_reference_role role) : entity(e), role(role) {}
+    };
+
+    /// \effects Creates an empty index.
+    reference_index() = default;
+
+    reference_index(const reference_index&) = delete;
+    reference_index& operator=(const reference_index&) = delete;
+
+    /// \effects Adds the references of all entities in the file.
+    /// \requires The file must live as long as the index lives.
+    /// \notes This operation is thread safe.
+    void add(const cpp_file& file);
+
+    /// \effects Adds the references of all entities in the files.
+    /// The files are processed in parallel by up to `thread_count` threads,
+    /// or one per hardware thread if it is `0`,
+    /// and the results are merged in the order of the files.
+    /// \requires The files must live as long as the index lives.
+    /// \notes This operation is thread safe.
+    void add(const std::vector<const cpp_file*>& files, unsigned thread_count = 0u);
+
+    /// \returns All references to the entity with the given id, in the order they were added.
+    /// \notes This operation is thread safe.
+    std::vector<reference> lookup(const cpp_entity_id& target) const;
+
+    /// \returns All entities referring to the entity with the given id in the given role,
+    /// in the order they were added.
+    /// \notes This operation is thread safe.
+    std::vector<type_safe::object_ref<const cpp_entity>> lookup(const cpp_entity_id& target,
+                                                                cpp_reference_role   role) const;
+
+    /// \returns The number of entities that are referred to.
+    /// \notes This operation is thread safe.
+    std::size_t size() const noexcept;
+
+private:
+    struct hash
+    {
+        std::size_t operator()(const cpp_entity_id& id) const noexcept
+        {
+            return std::size_t(static_cast<detail::hash_type>(id));
+        }
+    };
+
+    using map = std::unordered_map<cpp_entity_id, std::vector<reference>, hash>;
+
+    void merge(map& references);
+
+    mutable detail::shared_mutex mutex_;
+    map                          references_;
+};
+} // namespace cppast
+
+#endif // CPPAST_REFERENCE_INDEX_HPP_INCLUDED
@@ -0,0 +1,206 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_SIDE_TABLE_HPP_INCLUDED
+#define CPPAST_SIDE_TABLE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <type_safe/optional_ref.hpp>
+
+#include <cppast/cpp_entity.hpp>
+#include <cppast/cpp_entity_index.hpp>
+#include <cppast/detail/assert.hpp>
+
+namespace cppast
+{
+/// Stores a `T` for each [cppast::cpp_entity]().
+///
+/// The values are stored in a flat vector indexed by the [cppast::cpp_entity::dense_index](),
+/// so unlike the user data, multiple analyses can attach data at the same time,
+/// and unlike a hash map, a lookup is a single array access.
+/// Values that weren't set are value initialized.
+///
+/// \requires `T` must be default constructible and not `bool`,
+/// use [cppast::entity_bitset]() for that.
+/// \notes It is not thread safe, use one table per thread or synchronize externally.
+template <typename T>
+class side_table
+{
+public:
+    /// \effects Creates an empty table.
+    side_table() = default;
+
+    /// \effects Creates a table with storage for all entities registered in the index so far.
+    explicit side_table(const cpp_entity_index& idx) : values_(idx.dense_index_count()) {}
+
+    /// \returns A reference to the value of the entity.
+    /// The table grows if necessary, e.g. if another file was registered after it was created.
+    /// \requires The entity must be part of a registered [cppast::cpp_file]().
+    T& operator[](const cpp_entity& e)
+    {
+        auto index = e.dense_index();
+        DEBUG_ASSERT(index != invalid_dense_index, detail::precondition_error_handler{},
+                     "entity is not part of a registered file");
+        if (index >= values_.size())
+            values_.resize(index + 1u);
+        return values_[index];
+    }
+
+    /// \returns A [ts::optional_ref]() to the value of the entity,
+    /// or an empty optional if the table has no storage for the entity.
+    type_safe::optional_ref<const T> lookup(const cpp_entity& e) const noexcept
+    {
+        auto index = e.dense_index();
+        if (index >= values_.size())
+            return type_safe::nullopt;
+        return type_safe::ref(values_[index]);
+    }
+
+    /// \returns The number of entities the table has storage for.
+    std::size_t size() const noexcept
+    {
+        return values_.size();
+    }
+
+    /// \effects Resets all values.
+    void clear() noexcept
+    {
+        values_.clear();
+    }
+
+private:
+    std::vector<T> values_;
+};
+
+/// A set of [cppast::cpp_entity]() objects.
+///
+/// It stores one bit per [cppast::cpp_entity::dense_index](),
+/// so membership tests and set operations work on whole words.
+/// This makes it suitable for reachability analyses, e.g. marking all entities used by a
+/// binding, as well as for combining the results of multiple analyses.
+class entity_bitset
+{
+public:
+    /// \effects Creates an empty set.
+    entity_bitset() = default;
+
+    /// \effects Creates an empty set with storage for all entities registered in the index so far.
+    explicit entity_bitset(const cpp_entity_index& idx)
+    : words_((idx.dense_index_count() + word_bits - 1u) / word_bits, 0u)
+    {}
+
+    /// \effects Adds the entity to the set.
+    /// \returns `true` if it was not in the set before.
+    /// \requires The entity must be part of a registered [cppast::cpp_file]().
+    bool insert(const cpp_entity& e)
+    {
+        auto index = e.dense_index();
+        DEBUG_ASSERT(index != invalid_dense_index, detail::precondition_error_handler{},
+                     "entity is not part of a registered file");
+        if (index / word_bits >= words_.size())
+            words_.resize(index / word_bits + 1u, 0u);
+
+        auto& word    = words_[index / word_bits];
+        auto  mask    = word_type(1u) << (index % word_bits);
+        auto  was_set = (word & mask) != 0u;
+        word |= mask;
+        return !was_set;
+    }
+
+    /// \effects Removes the entity from the set.
+    void erase(const cpp_entity& e) noexcept
+    {
+        auto index = e.dense_index();
+        if (index / word_bits < words_.size())
+            words_[index / word_bits] &= ~(word_type(1u) << (index % word_bits));
+    }
+
+    /// \returns Whether or not the entity is in the set.
+    bool contains(const cpp_entity& e) const noexcept
+    {
+        return contains(e.dense_index());
+    }
+
+    /// \returns Whether or not the entity with the given [cppast::cpp_entity::dense_index]() is
+    /// in the set.
+    bool contains(std::uint_least32_t index) const noexcept
+    {
+        return index / word_bits < words_.size()
+               && (words_[index / word_bits] & (word_type(1u) << (index % word_bits))) != 0u;
+    }
+
+    /// \returns The number of entities in the set.
+    std::size_t count() const noexcept;
+
+    /// \returns Whether or not the set is empty.
+    bool empty() const noexcept;
+
+    /// \effects Removes all entities from the set.
+    void clear() noexcept
+    {
+        words_.clear();
+    }
+
+    /// \effects Invokes the function with the [cppast::cpp_entity::dense_index]() of each entity
+    /// in the set, in increasing order.
+    /// Use [cppast::cpp_entity_index::lookup_dense_index]() to get the entity.
+    template <typename Func>
+    void for_each(Func f) const
+    {
+        for (auto i = std::size_t(0); i != words_.size(); ++i)
+            for (auto word = words_[i]; word != 0u; word &= word - 1u)
+                f(std::uint_least32_t(i * word_bits + lowest_bit(word)));
+    }
+
+    /// \effects Adds all entities of `other` to the set.
+    entity_bitset& operator|=(const entity_bitset& other);
+
+    /// \effects Removes all entities that aren't in `other` from the set.
+    entity_bitset& operator&=(const entity_bitset& other) noexcept;
+
+    /// \effects Removes all entities of `other` from the set.
+    entity_bitset& operator-=(const entity_bitset& other) noexcept;
+
+    /// \returns Whether or not both sets contain the same entities.
+    friend bool operator==(const entity_bitset& lhs, const entity_bitset& rhs) noexcept;
+
+    friend bool operator!=(const entity_bitset& lhs, const entity_bitset& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    /// \returns The union of both sets.
+    friend entity_bitset operator|(entity_bitset lhs, const entity_bitset& rhs)
+    {
+        lhs |= rhs;
+        return lhs;
+    }
+
+    /// \returns The intersection of both sets.
+    friend entity_bitset operator&(entity_bitset lhs, const entity_bitset& rhs)
+    {
+        lhs &= rhs;
+        return lhs;
+    }
+
+    /// \returns The entities of `lhs` that aren't in `rhs`.
+    friend entity_bitset operator-(entity_bitset lhs, const entity_bitset& rhs)
+    {
+        lhs -= rhs;
+        return lhs;
+    }
+
+private:
+    using word_type                     = std::uint_least64_t;
+    static constexpr unsigned word_bits = 64u;
+
+    static unsigned lowest_bit(word_type word) noexcept;
+
+    std::vector<word_type> words_;
+};
+} // namespace cppast
+
+#endif // CPPAST_SIDE_TABLE_HPP_INCLUDED
@@ -0,0 +1,42 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_STRUCTURAL_HASH_HPP_INCLUDED
+#define CPPAST_STRUCTURAL_HASH_HPP_INCLUDED
+
+#include <cstdint>
+
+#include <cppast/cppast_fwd.hpp>
+
+namespace cppast
+{
+/// \returns A hash of the structure of the type.
+///
+/// It combines the [cppast::cpp_type_kind]() with the kind specific information,
+/// e.g. the hashes of the types it is composed of, or the name and id of a referenced entity.
+/// Two types that are spelled the same have the same hash,
+/// independent of the parse they come from.
+///
+/// \notes The hash is computed on the first call and cached in the type,
+/// so the type must not be modified afterwards.
+std::uint_least64_t structural_hash(const cpp_type& type);
+
+/// \returns A hash of the structure of the entity and all of its children.
+///
+/// It combines the [cppast::cpp_entity_kind](), the name, the documentation comment,
+/// the attributes, the kind specific information like types, specifiers and default values,
+/// and the hashes of the child entities in order, e.g. members, bases, function and template
+/// parameters. It does not depend on the parent or the source location of the entity, so an
+/// unchanged entity has the same hash in two different parses.
+///
+/// This allows comparing two versions of an AST without a full walk:
+/// if the hashes of two entities are equal, the subtrees are equal (up to a hash collision),
+/// otherwise only the children with different hashes need to be compared.
+///
+/// \notes The hash is computed bottom-up on the first call and cached in each entity,
+/// so later calls for the entity or any of its children are constant time.
+/// The entity must not be modified afterwards.
+std::uint_least64_t structural_hash(const cpp_entity& e);
+} // namespace cppast
+
+#endif // CPPAST_STRUCTURAL_HASH_HPP_INCLUDED
@@ -0,0 +1,139 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/aggregating_diagnostic_logger.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+using namespace cppast;
+
+namespace
+{
+void hash_combine(std::size_t& seed, std::size_t value) noexcept
+{
+    seed ^= value + 0x9e3779b9u + (seed << 6u) + (seed >> 2u);
+}
+
+std::size_t hash_diagnostic(const diagnostic& d)
+{
+    auto result = std::hash<std::string>()(d.message);
+    hash_combine(result, d.location.file ? std::hash<std::string>()(d.location.file.value()) : 0u);
+    hash_combine(result, d.location.line ? std::size_t(d.location.line.value()) + 1u : 0u);
+    hash_combine(result, std::size_t(d.severity));
+    return result;
+}
+
+template <typename T>
+bool equal(const type_safe::optional<T>& a, const type_safe::optional<T>& b)
+{
+    if (a.has_value() != b.has_value())
+        return false;
+    return !a.has_value() || a.value() == b.value();
+}
+
+bool equal(const diagnostic& a, const diagnostic& b)
+{
+    return a.severity == b.severity && equal(a.location.line, b.location.line)
+           && a.message == b.message && equal(a.location.file, b.location.file);
+}
+
+template <typename Map>
+auto find_entry(Map& map, std::size_t hash, const diagnostic& d) -> decltype(&map.begin()->second)
+{
+    auto range = map.equal_range(hash);
+    for (auto iter = range.first; iter != range.second; ++iter)
+        if (equal(iter->second.diag, d))
+            return &iter->second;
+    return nullptr;
+}
+
+template <typename T>
+std::tuple<bool, const T&> get_key(const type_safe::optional<T>& value)
+{
+    // unknown files and lines come first
+    static const T unknown{};
+    return std::tuple<bool, const T&>(value.has_value(), value ? value.value() : unknown);
+}
+} // namespace
+
+std::vector<aggregated_diagnostic> aggregating_diagnostic_logger::summary() const
+{
+    std::vector<aggregated_diagnostic> result;
+    for (auto& s : shards_)
+    {
+        detail::shared_lock lock(s.mutex);
+        for (auto& e : s.map)
+            result.push_back({e.second.source, e.second.diag,
+                              e.second.count.load(std::memory_order_relaxed)});
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const aggregated_diagnostic& a, const aggregated_diagnostic& b) {
+                  auto& loc_a = a.diag.location;
+                  auto& loc_b = b.diag.location;
+                  if (a.count != b.count)
+                      return a.count > b.count;
+                  else if (get_key(loc_a.file) != get_key(loc_b.file))
+                      return get_key(loc_a.file) < get_key(loc_b.file);
+                  else if (get_key(loc_a.line) != get_key(loc_b.line))
+                      return get_key(loc_a.line) < get_key(loc_b.line);
+                  else if (a.diag.severity != b.diag.severity)
+                      return a.diag.severity < b.diag.severity;
+                  else
+                      return a.diag.message < b.diag.message;
+              });
+    return result;
+}
+
+std::size_t aggregating_diagnostic_logger::log_summary() const
+{
+    auto count = std::size_t(0u);
+    for (auto& aggregated : summary())
+    {
+        if (aggregated.count <= 1u)
+            // sorted by count, so all remaining ones are only reported once
+            break;
+
+        auto d = format_diagnostic(severity::info, aggregated.diag.location,
+                                   to_string(aggregated.diag.severity), " '",
+                                   aggregated.diag.message, "' reported ", aggregated.count,
+                                   " times");
+        if (target_->log("diagnostic summary", d))
+            ++count;
+    }
+    return count;
+}
+
+bool aggregating_diagnostic_logger::do_log(const char* source, const diagnostic& d) const
+{
+    auto  hash = hash_diagnostic(d);
+    auto& s    = shards_[hash >> (sizeof(std::size_t) * 8u - shard_bits)];
+
+    {
+        // fast path: the diagnostic is a repeat, only needs a shared lock
+        detail::shared_lock lock(s.mutex);
+        if (auto e = find_entry(s.map, hash, d))
+        {
+            e->count.fetch_add(1u, std::memory_order_relaxed);
+            repeats_.fetch_add(1u, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    {
+        std::lock_guard<detail::shared_mutex> lock(s.mutex);
+        // another thread might have inserted it in the meantime
+        if (auto e = find_entry(s.map, hash, d))
+        {
+            e->count.fetch_add(1u, std::memory_order_relaxed);
+            repeats_.fetch_add(1u, std::memory_order_relaxed);
+            return false;
+        }
+        s.map.emplace(std::piecewise_construct, std::forward_as_tuple(hash),
+                      std::forward_as_tuple(source, d));
+    }
+
+    return target_->log(source, d);
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/buffered_diagnostic_logger.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+using namespace cppast;
+
+struct buffered_diagnostic_logger::node
+{
+    entry value;
+    node* next;
+};
+
+buffered_diagnostic_logger::buffered_diagnostic_logger(
+    type_safe::object_ref<const diagnostic_logger> target)
+: diagnostic_logger(target->is_verbose()), target_(target), queue_(nullptr)
+{}
+
+buffered_diagnostic_logger::~buffered_diagnostic_logger() noexcept
+{
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+        // the target threw, discard the diagnostics that are still queued
+        auto cur = queue_.exchange(nullptr, std::memory_order_acquire);
+        while (cur)
+        {
+            auto next = cur->next;
+            delete cur;
+            cur = next;
+        }
+    }
+}
+
+namespace
+{
+std::tuple<bool, unsigned> get_key(const type_safe::optional<unsigned>& value)
+{
+    // unknown lines and columns come first
+    return std::make_tuple(value.has_value(), value.value_or(0u));
+}
+} // namespace
+
+std::size_t buffered_diagnostic_logger::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    drain();
+
+    auto count = std::size_t(0u);
+    for (auto& file : buffer_)
+    {
+        auto& entries = file.second;
+        std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) {
+            auto& loc_a = a.diag.location;
+            auto& loc_b = b.diag.location;
+            if (get_key(loc_a.line) != get_key(loc_b.line))
+                return get_key(loc_a.line) < get_key(loc_b.line);
+            else if (get_key(loc_a.column) != get_key(loc_b.column))
+                return get_key(loc_a.column) < get_key(loc_b.column);
+            else if (a.diag.severity != b.diag.severity)
+                return a.diag.severity < b.diag.severity;
+            else if (a.diag.message != b.diag.message)
+                return a.diag.message < b.diag.message;
+            else
+                return std::strcmp(a.source, b.source) < 0;
+        });
+
+        for (auto& e : entries)
+            if (target_->log(e.source, e.diag))
+                ++count;
+    }
+    buffer_.clear();
+
+    return count;
+}
+
+bool buffered_diagnostic_logger::do_log(const char* source, const diagnostic& d) const
+{
+    auto n = new node{entry{source, d}, queue_.load(std::memory_order_relaxed)};
+    while (!queue_.compare_exchange_weak(n->next, n, std::memory_order_release,
+                                         std::memory_order_relaxed))
+        ;
+    return true;
+}
+
+void buffered_diagnostic_logger::drain()
+{
+    // taking the entire queue at once means no node is ever popped while being pushed
+    auto cur = queue_.exchange(nullptr, std::memory_order_acquire);
+    while (cur)
+    {
+        auto& e = cur->value;
+        buffer_[e.diag.location.file.value_or("")].push_back(std::move(e));
+
+        auto next = cur->next;
+        delete cur;
+        cur = next;
+    }
+}
@@ -0,0 +1,211 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/class_hierarchy.hpp>
+
+#include <algorithm>
+
+#include <cppast/cpp_class.hpp>
+#include <cppast/cpp_entity_index.hpp>
+#include <cppast/cpp_entity_kind.hpp>
+#include <cppast/detail/assert.hpp>
+
+using namespace cppast;
+
+namespace
+{
+unsigned lowest_bit(std::uint_least64_t word) noexcept
+{
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll(word));
+#else
+    auto result = 0u;
+    while ((word & 1u) == 0u)
+    {
+        word >>= 1u;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+bool is_class_definition(const cpp_entity& e) noexcept
+{
+    return e.kind() == cpp_entity_kind::class_t
+           && static_cast<const cpp_class&>(e).is_definition();
+}
+} // namespace
+
+class_hierarchy::class_hierarchy(const cpp_entity_index& idx) : words_per_row_(0u)
+{
+    auto entity_count = idx.dense_index_count();
+    class_indices_.assign(entity_count, std::uint_least32_t(invalid_index));
+
+    // collect the classes, using a temporary index
+    std::vector<const cpp_class*> classes;
+    for (auto i = std::uint_least32_t(0); i != entity_count; ++i)
+    {
+        auto entity = idx.lookup_dense_index(i);
+        if (entity && is_class_definition(entity.value()))
+        {
+            class_indices_[i] = std::uint_least32_t(classes.size());
+            classes.push_back(&static_cast<const cpp_class&>(entity.value()));
+        }
+    }
+
+    // resolve the direct bases
+    std::vector<std::vector<std::uint_least32_t>> direct_bases(classes.size());
+    std::vector<std::vector<std::uint_least32_t>> direct_derived(classes.size());
+    for (auto i = std::uint_least32_t(0); i != classes.size(); ++i)
+        for (auto& base : classes[i]->bases())
+        {
+            auto base_class = get_class(idx, base);
+            if (!base_class || !contains(base_class.value()))
+                continue;
+
+            auto base_index = get_index(base_class.value());
+            if (base_index == i
+                || std::find(direct_bases[i].begin(), direct_bases[i].end(), base_index)
+                       != direct_bases[i].end())
+                continue;
+            direct_bases[i].push_back(base_index);
+            direct_derived[base_index].push_back(i);
+        }
+
+    // sort them topologically, in the original order where possible
+    std::vector<std::uint_least32_t> order;
+    order.reserve(classes.size());
+    std::vector<std::size_t> missing_bases(classes.size());
+    for (auto i = std::uint_least32_t(0); i != classes.size(); ++i)
+    {
+        missing_bases[i] = direct_bases[i].size();
+        if (missing_bases[i] == 0u)
+            order.push_back(i);
+    }
+    for (auto i = std::size_t(0); i != order.size(); ++i)
+        for (auto derived : direct_derived[order[i]])
+            if (--missing_bases[derived] == 0u)
+                order.push_back(derived);
+    if (order.size() != classes.size())
+        // a cycle, can only happen in invalid code, break it arbitrarily
+        for (auto i = std::uint_least32_t(0); i != classes.size(); ++i)
+            if (missing_bases[i] != 0u)
+                order.push_back(i);
+
+    // the final index is the position in the topological order
+    std::vector<std::uint_least32_t> new_index(classes.size());
+    for (auto i = std::uint_least32_t(0); i != order.size(); ++i)
+        new_index[order[i]] = i;
+
+    classes_.reserve(classes.size());
+    direct_bases_.resize(classes.size());
+    direct_derived_.resize(classes.size());
+    for (auto i = std::uint_least32_t(0); i != order.size(); ++i)
+    {
+        classes_.push_back(type_safe::ref(*classes[order[i]]));
+        for (auto base : direct_bases[order[i]])
+            direct_bases_[i].push_back(new_index[base]);
+        for (auto derived : direct_derived[order[i]])
+            direct_derived_[i].push_back(new_index[derived]);
+    }
+    for (auto& index : class_indices_)
+        if (index != invalid_index)
+            index = new_index[index];
+
+    // compute the closures, bases before derived classes and vice versa
+    words_per_row_ = (classes_.size() + word_bits - 1u) / word_bits;
+    bases_.assign(classes_.size() * words_per_row_, 0u);
+    derived_.assign(classes_.size() * words_per_row_, 0u);
+    for (auto i = std::size_t(0); i != classes_.size(); ++i)
+        for (auto base : direct_bases_[i])
+        {
+            auto row = bases_.begin() + std::ptrdiff_t(i * words_per_row_);
+            std::transform(row, row + std::ptrdiff_t(words_per_row_),
+                           bases_.begin() + std::ptrdiff_t(base * words_per_row_), row,
+                           [](word_type a, word_type b) { return a | b; });
+            row[std::ptrdiff_t(base / word_bits)] |= word_type(1u) << (base % word_bits);
+        }
+    for (auto i = classes_.size(); i-- != 0u;)
+        for (auto derived : direct_derived_[i])
+        {
+            auto row = derived_.begin() + std::ptrdiff_t(i * words_per_row_);
+            std::transform(row, row + std::ptrdiff_t(words_per_row_),
+                           derived_.begin() + std::ptrdiff_t(derived * words_per_row_), row,
+                           [](word_type a, word_type b) { return a | b; });
+            row[std::ptrdiff_t(derived / word_bits)] |= word_type(1u) << (derived % word_bits);
+        }
+}
+
+bool class_hierarchy::contains(const cpp_class& c) const noexcept
+{
+    return get_index(c) != invalid_index;
+}
+
+std::vector<type_safe::object_ref<const cpp_class>> class_hierarchy::direct_bases(
+    const cpp_class& c) const
+{
+    return get_classes(direct_bases_[get_checked_index(c)]);
+}
+
+std::vector<type_safe::object_ref<const cpp_class>> class_hierarchy::direct_derived_classes(
+    const cpp_class& c) const
+{
+    return get_classes(direct_derived_[get_checked_index(c)]);
+}
+
+std::vector<type_safe::object_ref<const cpp_class>> class_hierarchy::bases(
+    const cpp_class& c) const
+{
+    return get_row(bases_, get_checked_index(c));
+}
+
+std::vector<type_safe::object_ref<const cpp_class>> class_hierarchy::derived_classes(
+    const cpp_class& c) const
+{
+    return get_row(derived_, get_checked_index(c));
+}
+
+bool class_hierarchy::is_derived_from(const cpp_class& derived,
+                                      const cpp_class& base) const noexcept
+{
+    auto derived_index = get_index(derived);
+    auto base_index    = get_index(base);
+    return derived_index != invalid_index && base_index != invalid_index
+           && test(bases_, derived_index, base_index);
+}
+
+std::uint_least32_t class_hierarchy::get_index(const cpp_class& c) const noexcept
+{
+    auto index = c.dense_index();
+    if (index >= class_indices_.size())
+        return invalid_index;
+    return class_indices_[index];
+}
+
+std::uint_least32_t class_hierarchy::get_checked_index(const cpp_class& c) const noexcept
+{
+    auto index = get_index(c);
+    DEBUG_ASSERT(index != invalid_index, detail::precondition_error_handler{},
+                 "class is not part of the hierarchy");
+    return index;
+}
+
+std::vector<type_safe::object_ref<const cpp_class>> class_hierarchy::get_row(
+    const std::vector<word_type>& closure, std::uint_least32_t row) const
+{
+    std::vector<type_safe::object_ref<const cpp_class>> result;
+    for (auto i = std::size_t(0); i != words_per_row_; ++i)
+        for (auto word = closure[row * words_per_row_ + i]; word != 0u; word &= word - 1u)
+            result.push_back(classes_[i * word_bits + lowest_bit(word)]);
+    return result;
+}
+
+std::vector<type_safe::object_ref<const cpp_class>> class_hierarchy::get_classes(
+    const std::vector<std::uint_least32_t>& indices) const
+{
+    std::vector<type_safe::object_ref<const cpp_class>> result;
+    result.reserve(indices.size());
+    for (auto index : indices)
+        result.push_back(classes_[index]);
+    return result;
+}
@@ -3,12 +3,19 @@
 
 #include <cppast/code_generator.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #include <cppast/cpp_alias_template.hpp>
 #include <cppast/cpp_class.hpp>
 #include <cppast/cpp_class_template.hpp>
 #include <cppast/cpp_entity_kind.hpp>
 #include <cppast/cpp_enum.hpp>
 #include <cppast/cpp_file.hpp>
+#include <cppast/cpp_file_edit.hpp>
 #include <cppast/cpp_friend.hpp>
 #include <cppast/cpp_function.hpp>
 #include <cppast/cpp_function_template.hpp>
@@ -26,6 +33,155 @@
 
 using namespace cppast;
 
+namespace cppast
+{
+namespace detail
+{
+    // generates the modified file of an edit:
+    // forwards everything to the target generator,
+    // the children of the generated entities are looked up in the edit
+    class edit_generator final : public code_generator
+    {
+    public:
+        edit_generator(code_generator& target, const cpp_file_edit& edit)
+        : target_(target), edit_(edit), previous_(active_)
+        {
+            // a buffered generator is written to directly
+            buffer_             = target.buffer_;
+            target.main_entity_ = type_safe::ref(edit.original());
+            active_             = this;
+        }
+
+        ~edit_generator() noexcept override
+        {
+            target_.main_entity_ = nullptr;
+            active_              = previous_;
+        }
+
+        // returns the edit if the generator is an edit_generator that is currently generating
+        static const cpp_file_edit* get_edit(const code_generator& generator) noexcept
+        {
+            for (auto cur = active_; cur; cur = cur->previous_)
+                if (cur == &generator)
+                    return &cur->edit_;
+            return nullptr;
+        }
+
+    private:
+        formatting do_get_formatting() const override
+        {
+            return target_.do_get_formatting();
+        }
+
+        generation_options do_get_options(const cpp_entity&                 e,
+                                          cppast::cpp_access_specifier_kind access) override
+        {
+            return target_.do_get_options(e, access);
+        }
+
+        void on_begin(const output& out, const cpp_entity& e) override
+        {
+            target_.on_begin(out, e);
+        }
+
+        void on_end(const output& out, const cpp_entity& e) override
+        {
+            target_.on_end(out, e);
+        }
+
+        void on_container_end(const output& out, const cpp_entity& e) override
+        {
+            target_.on_container_end(out, e);
+        }
+
+        void do_indent() override
+        {
+            target_.do_indent();
+        }
+
+        void do_unindent() override
+        {
+            target_.do_unindent();
+        }
+
+        void do_write_token_seq(string_view tokens) override
+        {
+            target_.do_write_token_seq(tokens);
+        }
+
+        void do_write_keyword(string_view keyword) override
+        {
+            target_.do_write_keyword(keyword);
+        }
+
+        void do_write_identifier(string_view identifier) override
+        {
+            target_.do_write_identifier(identifier);
+        }
+
+        bool do_write_reference(type_safe::array_ref<const cpp_entity_id> id,
+                                string_view                               name) override
+        {
+            return target_.do_write_reference(id, name);
+        }
+
+        void do_write_punctuation(string_view punct) override
+        {
+            target_.do_write_punctuation(punct);
+        }
+
+        void do_write_str_literal(string_view str) override
+        {
+            target_.do_write_str_literal(str);
+        }
+
+        void do_write_int_literal(string_view str) override
+        {
+            target_.do_write_int_literal(str);
+        }
+
+        void do_write_float_literal(string_view str) override
+        {
+            target_.do_write_float_literal(str);
+        }
+
+        void do_write_preprocessor(string_view punct) override
+        {
+            target_.do_write_preprocessor(punct);
+        }
+
+        void do_write_comment(string_view c) override
+        {
+            target_.do_write_comment(c);
+        }
+
+        void do_write_excluded(const cpp_entity& e) override
+        {
+            target_.do_write_excluded(e);
+        }
+
+        void do_write_newline() override
+        {
+            target_.do_write_newline();
+        }
+
+        void do_write_whitespace() override
+        {
+            target_.do_write_whitespace();
+        }
+
+        code_generator&      target_;
+        const cpp_file_edit& edit_;
+        edit_generator*      previous_;
+
+        // the edit generators that are generating on this thread, innermost first
+        static thread_local edit_generator* active_;
+    };
+
+    thread_local edit_generator* edit_generator::active_ = nullptr;
+} // namespace detail
+} // namespace cppast
+
 namespace
 {
 void opening_brace(const code_generator::output& output)
@@ -59,13 +215,40 @@ void operator_ws(const code_generator::output& output)
 bool generate_code_impl(code_generator& generator, const cpp_entity& e,
                         cpp_access_specifier_kind cur_access);
 
+// calls f with every child of the container, as modified by the edit that is being generated
+template <class Container, typename Func>
+void for_each_child(const code_generator::output& output, const Container& cont, Func f)
+{
+    auto edit = detail::edit_generator::get_edit(*output.generator());
+    for (auto& child : cont)
+        if (!edit)
+            f(child);
+        else
+        {
+            for (auto& e : edit->inserted_before(child))
+                f(*e);
+            if (auto cur = edit->lookup(child))
+                f(cur.value());
+            for (auto& e : edit->inserted_after(child))
+                f(*e);
+        }
+}
+
+// generates the single child, as modified by the edit that is being generated
+bool generate_child(const code_generator::output& output, const cpp_entity& child,
+                    cpp_access_specifier_kind cur_access)
+{
+    auto edit = detail::edit_generator::get_edit(*output.generator());
+    auto cur  = edit ? edit->lookup(child) : type_safe::opt_cref(&child);
+    return cur && generate_code_impl(*output.generator(), cur.value(), cur_access);
+}
+
 template <class Container, typename Sep>
 bool write_container(code_generator::output& output, const Container& cont, Sep s,
                      cpp_access_specifier_kind cur_access)
 {
     auto need_sep = false;
-    for (auto& child : cont)
-    {
+    for_each_child(output, cont, [&](const cpp_entity& child) {
         auto is_excluded = output.options(child, cur_access).is_set(code_generator::exclude);
         if (!is_excluded)
         {
@@ -73,7 +256,7 @@ bool write_container(code_generator::output& output, const Container& cont, Sep
                 output << s;
             need_sep = generate_code_impl(*output.generator(), child, cur_access);
         }
-    }
+    });
     return need_sep;
 }
 
@@ -170,7 +353,7 @@ bool generate_language_linkage(code_generator& generator, const cpp_language_lin
         else
         {
             output << whitespace;
-            generate_code_impl(generator, *linkage.begin(), cur_access);
+            generate_child(output, *linkage.begin(), cur_access);
         }
     }
     return static_cast<bool>(output);
@@ -418,16 +601,13 @@ bool generate_class(code_generator& generator, const cpp_class& c,
             auto need_sep    = false;
             auto last_access = c.class_kind() == cpp_class_kind::class_t ? cpp_private : cpp_public;
             auto last_written_access = last_access;
-            for (auto& member : c)
-            {
+            for_each_child(output, c, [&](const cpp_entity& member) {
                 if (member.kind() == cpp_entity_kind::access_specifier_t)
                 {
                     auto& access = static_cast<const cpp_access_specifier&>(member);
                     last_access  = access.access_specifier();
                 }
-                else if (output.options(member, last_access).is_set(code_generator::exclude))
-                    continue;
-                else
+                else if (!output.options(member, last_access).is_set(code_generator::exclude))
                 {
                     if (need_sep)
                         output << newl;
@@ -438,7 +618,7 @@ bool generate_class(code_generator& generator, const cpp_class& c,
                     }
                     need_sep = generate_code_impl(generator, member, last_access);
                 }
-            }
+            });
 
             output.container_end();
 
@@ -859,7 +1039,7 @@ bool generate_friend(code_generator& generator, const cpp_friend& f,
     if (output)
     {
         if (auto e = f.entity())
-            generate_code_impl(generator, e.value(), cur_access);
+            generate_child(output, e.value(), cur_access);
         else if (auto type = f.type())
         {
             output << keyword("friend") << whitespace;
@@ -939,8 +1119,7 @@ void write_template_parameters(code_generator::output& output, const cpp_templat
 
     auto need_sep    = false;
     auto need_header = hide_if_empty;
-    for (auto& param : templ.parameters())
-    {
+    for_each_child(output, templ.parameters(), [&](const cpp_entity& param) {
         auto is_excluded = output.options(param, cpp_public).is_set(code_generator::exclude);
         if (!is_excluded)
         {
@@ -953,7 +1132,7 @@ void write_template_parameters(code_generator::output& output, const cpp_templat
                 output << comma;
             need_sep = generate_code_impl(*output.generator(), param, cpp_public);
         }
-    }
+    });
 
     if (!need_header)
         output << bracket_ws << punctuation(">") << newl;
@@ -966,7 +1145,7 @@ bool generate_alias_template(code_generator& generator, const cpp_alias_template
     if (output)
     {
         write_template_parameters(output, alias, true);
-        generate_code_impl(generator, alias.type_alias(), cur_access);
+        generate_child(output, alias.type_alias(), cur_access);
     }
     return static_cast<bool>(output);
 }
@@ -978,7 +1157,7 @@ bool generate_variable_template(code_generator& generator, const cpp_variable_te
     if (output)
     {
         write_template_parameters(output, var, true);
-        generate_code_impl(generator, var.variable(), cur_access);
+        generate_child(output, var.variable(), cur_access);
     }
     return static_cast<bool>(output);
 }
@@ -990,7 +1169,7 @@ bool generate_function_template(code_generator& generator, const cpp_function_te
     if (output)
     {
         write_template_parameters(output, func, true);
-        generate_code_impl(generator, func.function(), cur_access);
+        generate_child(output, func.function(), cur_access);
     }
     return static_cast<bool>(output);
 }
@@ -1146,6 +1325,127 @@ bool cppast::generate_code(code_generator& generator, const cpp_entity& e)
     return result;
 }
 
+bool cppast::generate_code(code_generator& generator, const cpp_file_edit& edit)
+{
+    detail::edit_generator adapter(generator, edit);
+    return generate_code(adapter, edit.original());
+}
+
+// generates the entities in parallel, shared by both overloads of generate_code_parallel()
+struct cppast::detail::parallel_generation
+{
+    struct result
+    {
+        std::string code;
+        bool        excluded  = false; // the entity wasn't generated at all
+        bool        generated = false; // the result of generate_code()
+    };
+
+    // if skip_excluded is true, entities excluded by the generation options aren't generated,
+    // like in write_container()
+    static std::vector<result> generate(
+        const buffered_code_generator_factory&                      factory,
+        const std::vector<type_safe::object_ref<const cpp_entity>>& entities,
+        unsigned thread_count, bool skip_excluded)
+    {
+        if (thread_count == 0u)
+            thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+        if (thread_count > entities.size())
+            thread_count = unsigned(entities.size());
+
+        // each entity is generated into its own buffer, so the threads don't need to synchronize
+        std::vector<result>      results(entities.size());
+        std::atomic<std::size_t> next(0u);
+        std::exception_ptr       error;
+        std::mutex               error_mutex;
+        auto                     worker = [&] {
+            for (auto i = next++; i < entities.size(); i = next++)
+            {
+                try
+                {
+                    auto            generator = factory();
+                    code_generator& base      = *generator;
+                    if (skip_excluded
+                        && base.do_get_options(*entities[i], cpp_public)
+                               .is_set(code_generator::exclude))
+                        results[i].excluded = true;
+                    else
+                    {
+                        results[i].generated = cppast::generate_code(base, *entities[i]);
+                        // keep the code even if it returned false, it might be custom
+                        results[i].code = generator->release();
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                    // stop handing out entities
+                    next = entities.size();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (auto i = 1u; i < thread_count; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+
+        if (error)
+            std::rethrow_exception(error);
+        return results;
+    }
+};
+
+std::vector<std::string> cppast::generate_code_parallel(
+    const buffered_code_generator_factory&                      factory,
+    const std::vector<type_safe::object_ref<const cpp_entity>>& entities,
+    unsigned                                                    thread_count)
+{
+    auto results
+        = detail::parallel_generation::generate(factory, entities, thread_count, false);
+
+    std::vector<std::string> code;
+    code.reserve(results.size());
+    for (auto& result : results)
+        code.push_back(std::move(result.code));
+    return code;
+}
+
+std::string cppast::generate_code_parallel(const buffered_code_generator_factory& factory,
+                                           const cpp_file& file, unsigned thread_count)
+{
+    std::vector<type_safe::object_ref<const cpp_entity>> entities;
+    for (auto& child : file)
+        entities.push_back(type_safe::ref(child));
+    auto results = detail::parallel_generation::generate(factory, entities, thread_count, true);
+
+    std::string code;
+    auto        size = std::size_t(0u);
+    for (auto& result : results)
+        size += result.code.size() + 1u;
+    code.reserve(size);
+
+    // same separators as write_container()
+    auto need_sep = false;
+    for (auto& result : results)
+    {
+        if (result.excluded)
+            continue;
+        else if (need_sep)
+            code += '\n';
+        code += result.code;
+        need_sep = result.generated;
+    }
+    if (!need_sep)
+        // file empty, write newline
+        code += '\n';
+    return code;
+}
+
 void detail::write_template_arguments(
     code_generator::output&                                                output,
     type_safe::optional<type_safe::array_ref<const cpp_template_argument>> arguments)
@@ -3,12 +3,39 @@
 
 #include <cppast/cpp_entity.hpp>
 
+#include <memory>
+
 #include <cppast/cpp_entity_index.hpp>
 #include <cppast/cpp_entity_kind.hpp>
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_forward_declarable.hpp>
 #include <cppast/cpp_template.hpp>
 
 using namespace cppast;
 
+namespace cppast
+{
+namespace detail
+{
+    struct cpp_name_cache
+    {
+        std::string qualified_name;
+        // the scope_path() of the children, empty if the entity isn't a named scope
+        std::string child_scope;
+    };
+
+    struct cpp_name_cache_access
+    {
+        static const cpp_name_cache& get(const cpp_entity& e);
+
+        static void destroy(const cpp_entity& e) noexcept
+        {
+            delete e.name_cache_.load(std::memory_order_relaxed);
+        }
+    };
+} // namespace detail
+} // namespace cppast
+
 cpp_scope_name::cpp_scope_name(type_safe::object_ref<const cpp_entity> entity) : entity_(entity)
 {
     if (cppast::is_templated(*entity))
@@ -37,6 +64,32 @@ detail::iteratable_intrusive_list<cpp_template_parameter> cpp_scope_name::templa
     return templ_.value().parameters();
 }
 
+cpp_entity::~cpp_entity() noexcept
+{
+    detail::cpp_name_cache_access::destroy(*this);
+}
+
+type_safe::optional_ref<const std::string> cpp_entity::comment() const
+{
+    if (!comment_.empty())
+        return type_safe::opt_ref(&comment_);
+    else if (comment_index_ == 0u)
+        return type_safe::nullopt;
+
+    // the comment is stored in the comment table of the file
+    auto root = this;
+    while (root->parent_)
+        root = &root->parent_.value();
+    if (root->kind() != cpp_entity_kind::file_t)
+        return type_safe::nullopt;
+
+    auto& table = static_cast<const cpp_file&>(*root).comment_table();
+    if (table[comment_index_ - 1u].size == 0u)
+        // empty comments are matched, but aren't comments of the entity
+        return type_safe::nullopt;
+    return type_safe::opt_ref(&table.text(comment_index_ - 1u));
+}
+
 cpp_entity_kind cpp_unexposed_entity::kind() noexcept
 {
     return cpp_entity_kind::unexposed_t;
@@ -70,3 +123,45 @@ bool cppast::is_templated(const cpp_entity& e) noexcept
         return false;
     return e.parent().value().name() == e.name();
 }
+
+namespace
+{
+// a template and the templated entity are the same scope, so only the latter counts
+bool is_named_scope(const cpp_entity& e)
+{
+    return !e.name().empty() && !is_template(e.kind()) && e.scope_name().has_value();
+}
+} // namespace
+
+const detail::cpp_name_cache& detail::cpp_name_cache_access::get(const cpp_entity& e)
+{
+    if (auto cache = e.name_cache_.load(std::memory_order_acquire))
+        return *cache;
+
+    std::unique_ptr<cpp_name_cache> cache(new cpp_name_cache());
+    // out of line definitions are in the scope of the semantic parent
+    cache->qualified_name = scope_path(e) + semantic_scope(e) + e.name();
+    if (is_named_scope(e))
+        cache->child_scope = cache->qualified_name + "::";
+
+    // if another thread was faster, use its result instead
+    cpp_name_cache* expected = nullptr;
+    if (!e.name_cache_.compare_exchange_strong(expected, cache.get(), std::memory_order_acq_rel,
+                                               std::memory_order_acquire))
+        return *expected;
+    return *cache.release();
+}
+
+const std::string& cppast::scope_path(const cpp_entity& e)
+{
+    static const std::string global_scope;
+    for (auto cur = e.parent(); cur; cur = cur.value().parent())
+        if (is_named_scope(cur.value()))
+            return detail::cpp_name_cache_access::get(cur.value()).child_scope;
+    return global_scope;
+}
+
+const std::string& cppast::qualified_name(const cpp_entity& e)
+{
+    return detail::cpp_name_cache_access::get(e).qualified_name;
+}
@@ -3,24 +3,197 @@
 
 #include <cppast/cpp_entity_index.hpp>
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#include <cppast/cpp_class.hpp>
 #include <cppast/cpp_entity.hpp>
 #include <cppast/cpp_entity_kind.hpp>
+#include <cppast/cpp_enum.hpp>
 #include <cppast/cpp_file.hpp>
+#include <cppast/cpp_friend.hpp>
+#include <cppast/cpp_function.hpp>
+#include <cppast/cpp_language_linkage.hpp>
+#include <cppast/cpp_namespace.hpp>
+#include <cppast/cpp_preprocessor.hpp>
+#include <cppast/cpp_template.hpp>
+#include <cppast/cpp_template_parameter.hpp>
 #include <cppast/detail/assert.hpp>
 
 using namespace cppast;
 
+namespace cppast
+{
+namespace detail
+{
+    struct cpp_dense_index_access
+    {
+        static void set(const cpp_entity& e, std::uint_least32_t index) noexcept
+        {
+            e.dense_index_.store(index, std::memory_order_relaxed);
+        }
+    };
+} // namespace detail
+} // namespace cppast
+
+namespace
+{
+template <typename Container>
+void number_children(std::vector<const cpp_entity*>& dense, const Container& container);
+
+// numbers the entity and all children, including the ones that aren't visited
+void number_entity(std::vector<const cpp_entity*>& dense, const cpp_entity& e)
+{
+    DEBUG_ASSERT(e.dense_index() == invalid_dense_index, detail::precondition_error_handler{},
+                 "entity already numbered by another index");
+    detail::cpp_dense_index_access::set(e, std::uint_least32_t(dense.size()));
+    dense.push_back(&e);
+
+    switch (e.kind())
+    {
+    case cpp_entity_kind::file_t:
+        number_children(dense, static_cast<const cpp_file&>(e));
+        break;
+    case cpp_entity_kind::language_linkage_t:
+        number_children(dense, static_cast<const cpp_language_linkage&>(e));
+        break;
+    case cpp_entity_kind::namespace_t:
+        number_children(dense, static_cast<const cpp_namespace&>(e));
+        break;
+    case cpp_entity_kind::enum_t:
+        number_children(dense, static_cast<const cpp_enum&>(e));
+        break;
+    case cpp_entity_kind::class_t:
+        number_children(dense, static_cast<const cpp_class&>(e).bases());
+        number_children(dense, static_cast<const cpp_class&>(e));
+        break;
+
+    case cpp_entity_kind::macro_definition_t:
+        number_children(dense, static_cast<const cpp_macro_definition&>(e).parameters());
+        break;
+    case cpp_entity_kind::function_t:
+    case cpp_entity_kind::member_function_t:
+    case cpp_entity_kind::conversion_op_t:
+    case cpp_entity_kind::constructor_t:
+    case cpp_entity_kind::destructor_t:
+        number_children(dense, static_cast<const cpp_function_base&>(e).parameters());
+        break;
+    case cpp_entity_kind::template_template_parameter_t:
+        number_children(dense,
+                        static_cast<const cpp_template_template_parameter&>(e).parameters());
+        break;
+    case cpp_entity_kind::friend_t:
+        if (auto entity = static_cast<const cpp_friend&>(e).entity())
+            number_entity(dense, entity.value());
+        break;
+
+    case cpp_entity_kind::alias_template_t:
+    case cpp_entity_kind::variable_template_t:
+    case cpp_entity_kind::function_template_t:
+    case cpp_entity_kind::function_template_specialization_t:
+    case cpp_entity_kind::class_template_t:
+    case cpp_entity_kind::class_template_specialization_t:
+        number_children(dense, static_cast<const cpp_template&>(e).parameters());
+        number_children(dense, static_cast<const cpp_template&>(e));
+        break;
+
+    default:
+        break;
+    }
+}
+
+template <typename Container>
+void number_children(std::vector<const cpp_entity*>& dense, const Container& container)
+{
+    for (auto& child : container)
+        number_entity(dense, child);
+}
+} // namespace
+
+namespace
+{
+// little endian read of up to 8 bytes, compilers turn the loop into a single load
+detail::hash_type read_bytes(const char* str, std::size_t length) noexcept
+{
+    auto result = detail::hash_type(0);
+    for (auto i = std::size_t(0); i != length; ++i)
+        result |= detail::hash_type(static_cast<unsigned char>(str[i])) << (8u * i);
+    return result;
+}
+
+// iterative version of detail::id_hash(), which has to be recursive to be constexpr in C++11
+detail::hash_type runtime_id_hash(const char* str, std::size_t length) noexcept
+{
+    auto hash = detail::hash_secret0 ^ detail::hash_type(length);
+
+    auto rest = length;
+    for (; rest > 16u; rest -= 16u, str += 16u)
+        hash = detail::hash_mum(read_bytes(str, 8u) ^ detail::hash_secret1,
+                                read_bytes(str + 8u, 8u) ^ hash);
+    hash = detail::hash_mum(read_bytes(str, rest < 8u ? rest : 8u) ^ detail::hash_secret1,
+                            (rest > 8u ? read_bytes(str + 8u, rest - 8u) : 0u) ^ hash);
+
+    return detail::hash_mum(hash ^ detail::hash_secret2,
+                            detail::hash_type(length) ^ detail::hash_secret1);
+}
+
+// the index that verifies the ids created by the current thread, if any
+thread_local const cpp_entity_index* verifying_index = nullptr;
+} // namespace
+
+detail::hash_type detail::checked_id_hash(const char* str, std::size_t length)
+{
+    auto hash = runtime_id_hash(str, length);
+    if (verifying_index)
+        verifying_index->verify_id(hash, str, length);
+    return hash;
+}
+
+cpp_entity_id_collision_error::cpp_entity_id_collision_error(const std::string& first,
+                                                             const std::string& second)
+: std::logic_error("cpp_entity_id collision between '" + first + "' and '" + second + "'")
+{}
+
 cpp_entity_index::duplicate_definition_error::duplicate_definition_error()
 : std::logic_error("duplicate registration of entity definition")
 {}
 
-void cpp_entity_index::register_definition(cpp_entity_id                           id,
-                                           type_safe::object_ref<const cpp_entity> entity) const
+cpp_entity_index::frozen_index_error::frozen_index_error()
+: std::logic_error("registration of entity in frozen index")
+{}
+
+namespace
 {
-    DEBUG_ASSERT(entity->kind() != cpp_entity_kind::namespace_t,
-                 detail::precondition_error_handler{}, "must not be a namespace");
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        result = map_.emplace(std::move(id), value(entity, true));
+// the batch that buffers the registrations of the current thread, if any
+thread_local cpp_entity_index::registration_batch* current_batch = nullptr;
+} // namespace
+
+cpp_entity_index::registration_batch::registration_batch(const cpp_entity_index& idx) noexcept
+: idx_(&idx), previous_(current_batch), committed_(false)
+{
+    current_batch = this;
+}
+
+cpp_entity_index::registration_batch::~registration_batch() noexcept
+{
+    DEBUG_ASSERT(current_batch == this, detail::precondition_error_handler{},
+                 "batches must be destroyed in reverse order");
+    current_batch = previous_;
+}
+
+auto cpp_entity_index::get_batch() const noexcept -> registration_batch*
+{
+    for (auto batch = current_batch; batch; batch = batch->previous_)
+        if (batch->idx_ == this && !batch->committed_)
+            return batch;
+    return nullptr;
+}
+
+void cpp_entity_index::insert_definition(shard& s, cpp_entity_id id,
+                                         type_safe::object_ref<const cpp_entity> entity)
+{
+    auto result = s.map.emplace(std::move(id), value(entity, true));
     if (!result.second)
     {
         // already in map, override declaration
@@ -34,33 +207,209 @@ void cpp_entity_index::register_definition(cpp_entity_id
     }
 }
 
+void cpp_entity_index::insert_declaration(shard& s, cpp_entity_id id,
+                                          type_safe::object_ref<const cpp_entity> entity)
+{
+    s.map.emplace(std::move(id), value(entity, false));
+}
+
+void cpp_entity_index::insert_namespace(shard& s, cpp_entity_id id,
+                                        type_safe::object_ref<const cpp_namespace> ns)
+{
+    s.ns[std::move(id)].push_back(ns);
+}
+
+void cpp_entity_index::register_definition(cpp_entity_id                           id,
+                                           type_safe::object_ref<const cpp_entity> entity) const
+{
+    DEBUG_ASSERT(entity->kind() != cpp_entity_kind::namespace_t,
+                 detail::precondition_error_handler{}, "must not be a namespace");
+    if (is_frozen())
+        throw frozen_index_error();
+    else if (auto batch = get_batch())
+    {
+        batch->entries_.emplace_back(std::move(id), &entity.get(),
+                                     registration_batch::entry_kind::definition);
+        return;
+    }
+
+    auto&                                 shard = get_shard(id);
+    std::lock_guard<detail::shared_mutex> lock(shard.mutex);
+    insert_definition(shard, std::move(id), entity);
+}
+
 bool cpp_entity_index::register_file(cpp_entity_id                         id,
                                      type_safe::object_ref<const cpp_file> file) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return map_.emplace(std::move(id), value(file, true)).second;
+    if (is_frozen())
+        throw frozen_index_error();
+    {
+        auto&                                 shard = get_shard(id);
+        std::lock_guard<detail::shared_mutex> lock(shard.mutex);
+        if (!shard.map.emplace(std::move(id), value(file, true)).second)
+            return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(dense_mutex_);
+        number_entity(dense_, *file);
+        DEBUG_ASSERT(dense_.size() < invalid_dense_index, detail::assert_handler{},
+                     "too many entities");
+    }
+
+    if (names_)
+        names_->add(*file);
+    return true;
 }
 
 void cpp_entity_index::register_forward_declaration(
     cpp_entity_id id, type_safe::object_ref<const cpp_entity> entity) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    map_.emplace(std::move(id), value(entity, false));
+    if (is_frozen())
+        throw frozen_index_error();
+    else if (auto batch = get_batch())
+    {
+        batch->entries_.emplace_back(std::move(id), &entity.get(),
+                                     registration_batch::entry_kind::declaration);
+        return;
+    }
+
+    auto&                                 shard = get_shard(id);
+    std::lock_guard<detail::shared_mutex> lock(shard.mutex);
+    insert_declaration(shard, std::move(id), entity);
 }
 
 void cpp_entity_index::register_namespace(cpp_entity_id                              id,
                                           type_safe::object_ref<const cpp_namespace> ns) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    ns_[std::move(id)].push_back(ns);
+    if (is_frozen())
+        throw frozen_index_error();
+    else if (auto batch = get_batch())
+    {
+        batch->entries_.emplace_back(std::move(id), &ns.get(),
+                                     registration_batch::entry_kind::namespace_);
+        return;
+    }
+
+    auto&                                 shard = get_shard(id);
+    std::lock_guard<detail::shared_mutex> lock(shard.mutex);
+    insert_namespace(shard, std::move(id), ns);
+}
+
+namespace
+{
+constexpr std::size_t shard_count = 16u;
+
+// returns the indices of the ids sorted by shard, and the begin of each shard in it
+template <typename Func>
+std::vector<std::size_t> sort_by_shard(std::size_t size, std::size_t (&begin)[shard_count + 1u],
+                                       Func get_shard_index)
+{
+    for (auto& b : begin)
+        b = 0u;
+    for (auto i = std::size_t(0); i != size; ++i)
+        ++begin[get_shard_index(i) + 1u];
+    for (auto i = std::size_t(0); i != shard_count; ++i)
+        begin[i + 1u] += begin[i];
+
+    // counting sort keeps the relative order inside a shard
+    std::vector<std::size_t> result(size);
+    std::size_t              pos[shard_count];
+    std::copy(begin, begin + shard_count, pos);
+    for (auto i = std::size_t(0); i != size; ++i)
+        result[pos[get_shard_index(i)]++] = i;
+    return result;
+}
+} // namespace
+
+void cpp_entity_index::register_batch(registration_batch& batch) const
+{
+    DEBUG_ASSERT(batch.idx_ == this, detail::precondition_error_handler{},
+                 "batch of a different index");
+    DEBUG_ASSERT(!batch.committed_, detail::precondition_error_handler{},
+                 "batch has already been committed");
+    static_assert(sizeof(shards_) / sizeof(shards_[0]) == shard_count, "shard count mismatch");
+    if (is_frozen())
+        throw frozen_index_error();
+
+    auto&       entries = batch.entries_;
+    std::size_t begin[shard_count + 1u];
+    auto        order = sort_by_shard(entries.size(), begin, [&](std::size_t i) {
+        return get_shard_index(entries[i].id);
+    });
+
+    // lock all affected shards up front (in order, so batches can't deadlock),
+    // then check for duplicate definitions before anything is inserted,
+    // so a throwing batch leaves the index unchanged
+    std::unique_lock<detail::shared_mutex> locks[shard_count];
+    for (auto s = std::size_t(0); s != shard_count; ++s)
+        if (begin[s] != begin[s + 1u])
+            locks[s] = std::unique_lock<detail::shared_mutex>(shards_[s].mutex);
+
+    std::unordered_map<cpp_entity_id, const cpp_entity*, hash> batch_definitions;
+    for (auto& entry : entries)
+    {
+        if (entry.kind != registration_batch::entry_kind::definition)
+            continue;
+
+        auto previous = batch_definitions.find(entry.id);
+        if (previous != batch_definitions.end())
+        {
+            if (!is_template(previous->second->kind()))
+                throw duplicate_definition_error();
+            previous->second = entry.entity;
+        }
+        else
+        {
+            auto& map  = get_shard(entry.id).map;
+            auto  iter = map.find(entry.id);
+            if (iter != map.end() && iter->second.is_definition
+                && !is_template(iter->second.entity->kind()))
+                throw duplicate_definition_error();
+            batch_definitions.emplace(entry.id, entry.entity);
+        }
+    }
+
+    for (auto s = std::size_t(0); s != shard_count; ++s)
+    {
+        auto& shard = shards_[s];
+        for (auto i = begin[s]; i != begin[s + 1u]; ++i)
+        {
+            auto& entry = entries[order[i]];
+            switch (entry.kind)
+            {
+            case registration_batch::entry_kind::definition:
+                insert_definition(shard, entry.id, type_safe::ref(*entry.entity));
+                break;
+            case registration_batch::entry_kind::declaration:
+                insert_declaration(shard, entry.id, type_safe::ref(*entry.entity));
+                break;
+            case registration_batch::entry_kind::namespace_:
+                insert_namespace(shard, entry.id,
+                                 type_safe::ref(static_cast<const cpp_namespace&>(*entry.entity)));
+                break;
+            }
+        }
+    }
+    entries.clear();
+    batch.committed_ = true;
 }
 
 type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup(
     const cpp_entity_id& id) const noexcept
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        iter = map_.find(id);
-    if (iter == map_.end())
+    if (is_frozen())
+    {
+        auto entry = lookup_frozen(id);
+        if (!entry)
+            return {};
+        return type_safe::ref(*entry->entity);
+    }
+
+    auto&               shard = get_shard(id);
+    detail::shared_lock lock(shard.mutex);
+    auto                iter = shard.map.find(id);
+    if (iter == shard.map.end())
         return {};
     return type_safe::ref(iter->second.entity.get());
 }
@@ -68,9 +417,18 @@ type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup(
 type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup_definition(
     const cpp_entity_id& id) const noexcept
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        iter = map_.find(id);
-    if (iter == map_.end() || !iter->second.is_definition)
+    if (is_frozen())
+    {
+        auto entry = lookup_frozen(id);
+        if (!entry || !entry->is_definition)
+            return {};
+        return type_safe::ref(*entry->entity);
+    }
+
+    auto&               shard = get_shard(id);
+    detail::shared_lock lock(shard.mutex);
+    auto                iter = shard.map.find(id);
+    if (iter == shard.map.end() || !iter->second.is_definition)
         return {};
     return type_safe::ref(iter->second.entity.get());
 }
@@ -78,10 +436,200 @@ type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup_definition(
 auto cpp_entity_index::lookup_namespace(const cpp_entity_id& id) const noexcept
     -> type_safe::array_ref<type_safe::object_ref<const cpp_namespace>>
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        iter = ns_.find(id);
-    if (iter == ns_.end())
+    if (is_frozen())
+    {
+        auto entry = lookup_frozen_namespace(id);
+        if (!entry)
+            return nullptr;
+        return type_safe::ref(entry->begin, entry->size);
+    }
+
+    auto&               shard = get_shard(id);
+    detail::shared_lock lock(shard.mutex);
+    auto                iter = shard.ns.find(id);
+    if (iter == shard.ns.end())
         return nullptr;
     auto& vec = iter->second;
     return type_safe::ref(vec.data(), vec.size());
 }
+
+std::vector<type_safe::optional_ref<const cpp_entity>> cpp_entity_index::lookup_many(
+    type_safe::array_ref<const cpp_entity_id> ids) const
+{
+    std::vector<type_safe::optional_ref<const cpp_entity>> result(ids.size());
+    if (is_frozen() || ids.size() == 1u)
+    {
+        for (auto i = std::size_t(0); i != ids.size(); ++i)
+            result[i] = lookup(ids[i]);
+        return result;
+    }
+
+    std::size_t begin[shard_count + 1u];
+    auto        order = sort_by_shard(ids.size(), begin, [&](std::size_t i) {
+        return get_shard_index(ids[i]);
+    });
+    for (auto s = std::size_t(0); s != shard_count; ++s)
+    {
+        if (begin[s] == begin[s + 1u])
+            continue;
+
+        auto&               shard = shards_[s];
+        detail::shared_lock lock(shard.mutex);
+        for (auto i = begin[s]; i != begin[s + 1u]; ++i)
+        {
+            auto iter = shard.map.find(ids[order[i]]);
+            if (iter != shard.map.end())
+                result[order[i]] = type_safe::ref(iter->second.entity.get());
+        }
+    }
+    return result;
+}
+
+std::uint_least32_t cpp_entity_index::dense_index_count() const noexcept
+{
+    if (is_frozen())
+        return std::uint_least32_t(dense_.size());
+
+    std::lock_guard<std::mutex> lock(dense_mutex_);
+    return std::uint_least32_t(dense_.size());
+}
+
+type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup_dense_index(
+    std::uint_least32_t index) const noexcept
+{
+    std::unique_lock<std::mutex> lock(dense_mutex_, std::defer_lock);
+    if (!is_frozen())
+        lock.lock();
+
+    if (index >= dense_.size())
+        return {};
+    return type_safe::ref(*dense_[index]);
+}
+
+namespace
+{
+std::size_t table_size(std::size_t count) noexcept
+{
+    // load factor at most 1/2
+    auto size = std::size_t(16u);
+    while (size < 2u * count)
+        size *= 2u;
+    return size;
+}
+} // namespace
+
+void cpp_entity_index::freeze()
+{
+    if (is_frozen())
+        return;
+
+    auto entity_count = std::size_t(0), ns_count = std::size_t(0);
+    for (auto& shard : shards_)
+    {
+        entity_count += shard.map.size();
+        ns_count += shard.ns.size();
+    }
+
+    frozen_map_.assign(table_size(entity_count), frozen_entity{0u, nullptr, false});
+    frozen_ns_.assign(table_size(ns_count), frozen_namespace{0u, nullptr, 0u});
+
+    auto entity_mask = frozen_map_.size() - 1u;
+    auto ns_mask     = frozen_ns_.size() - 1u;
+    for (auto& shard : shards_)
+    {
+        for (auto& pair : shard.map)
+        {
+            auto id   = static_cast<detail::hash_type>(pair.first);
+            auto slot = std::size_t(id) & entity_mask;
+            while (frozen_map_[slot].entity)
+                slot = (slot + 1u) & entity_mask;
+            frozen_map_[slot] = frozen_entity{id, &pair.second.entity.get(),
+                                              pair.second.is_definition};
+        }
+
+        for (auto& pair : shard.ns)
+        {
+            auto id   = static_cast<detail::hash_type>(pair.first);
+            auto slot = std::size_t(id) & ns_mask;
+            while (frozen_ns_[slot].size != 0u)
+                slot = (slot + 1u) & ns_mask;
+            frozen_ns_[slot] = frozen_namespace{id, pair.second.data(), pair.second.size()};
+        }
+
+        // no longer needed, but the namespace vectors are still referenced
+        shard.map.clear();
+    }
+
+    frozen_.store(true, std::memory_order_release);
+}
+
+void cpp_entity_index::enable_qualified_name_index()
+{
+    if (!names_)
+        names_.reset(new qualified_name_index());
+}
+
+void cpp_entity_index::enable_id_verification()
+{
+    if (!id_strings_)
+        id_strings_.reset(new id_strings());
+}
+
+cpp_entity_index::id_verification::id_verification(const cpp_entity_index& idx) noexcept
+: previous_(verifying_index)
+{
+    if (idx.id_strings_)
+        verifying_index = &idx;
+}
+
+cpp_entity_index::id_verification::~id_verification() noexcept
+{
+    verifying_index = previous_;
+}
+
+void cpp_entity_index::verify_id(detail::hash_type hash, const char* str, std::size_t length) const
+{
+    DEBUG_ASSERT(id_strings_ != nullptr, detail::assert_handler{}, "id verification not enabled");
+
+    std::lock_guard<std::mutex> lock(id_strings_->mutex);
+    auto result = id_strings_->strings.emplace(hash, std::string(str, length));
+    if (!result.second && result.first->second.compare(0, std::string::npos, str, length) != 0)
+        throw cpp_entity_id_collision_error(result.first->second, std::string(str, length));
+}
+
+void detail::verify_id_hash(const cpp_entity_index& idx, hash_type hash, const char* str,
+                            std::size_t length)
+{
+    idx.verify_id(hash, str, length);
+}
+
+auto cpp_entity_index::lookup_frozen(const cpp_entity_id& id) const noexcept
+    -> const frozen_entity*
+{
+    auto value = static_cast<detail::hash_type>(id);
+    auto mask  = frozen_map_.size() - 1u;
+    auto slot  = std::size_t(value) & mask;
+    // the table is never full, so there is always an empty slot
+    while (frozen_map_[slot].entity)
+    {
+        if (frozen_map_[slot].id == value)
+            return &frozen_map_[slot];
+        slot = (slot + 1u) & mask;
+    }
+    return nullptr;
+}
+
+auto cpp_entity_index::lookup_frozen_namespace(const cpp_entity_id& id) const noexcept
+    -> const frozen_namespace*
+{
+    auto value = static_cast<detail::hash_type>(id);
+    auto mask  = frozen_ns_.size() - 1u;
+    auto slot  = std::size_t(value) & mask;
+    while (frozen_ns_[slot].size != 0u)
+    {
+        if (frozen_ns_[slot].id == value)
+            return &frozen_ns_[slot];
+        slot = (slot + 1u) & mask;
+    }
+    return nullptr;
+}
@@ -3,10 +3,62 @@
 
 #include <cppast/cpp_file.hpp>
 
+#include <algorithm>
+
 #include <cppast/cpp_entity_kind.hpp>
+#include <cppast/detail/assert.hpp>
 
 using namespace cppast;
 
+cpp_doc_comment_table::cpp_doc_comment_table(std::string buffer, std::vector<entry> entries)
+: buffer_(std::move(buffer)), entries_(std::move(entries)),
+  cache_(new std::atomic<const std::string*>[entries_.size()]())
+{}
+
+cpp_doc_comment_table::~cpp_doc_comment_table() noexcept
+{
+    if (cache_)
+        for (std::size_t i = 0u; i != entries_.size(); ++i)
+            delete cache_[i].load();
+}
+
+cpp_doc_comment_table& cpp_doc_comment_table::operator=(cpp_doc_comment_table&& other) noexcept
+{
+    cpp_doc_comment_table tmp(std::move(other));
+    std::swap(buffer_, tmp.buffer_);
+    std::swap(entries_, tmp.entries_);
+    std::swap(cache_, tmp.cache_);
+    return *this;
+}
+
+const std::string& cpp_doc_comment_table::text(std::size_t index) const
+{
+    DEBUG_ASSERT(index < entries_.size(), detail::precondition_error_handler{},
+                 "comment index out of range");
+    auto& cached = cache_[index];
+    if (auto str = cached.load(std::memory_order_acquire))
+        return *str;
+
+    auto&                              e = entries_[index];
+    std::unique_ptr<const std::string> str(new std::string(buffer_, e.offset, e.size));
+    const std::string*                 expected = nullptr;
+    if (cached.compare_exchange_strong(expected, str.get(), std::memory_order_acq_rel,
+                                       std::memory_order_acquire))
+        return *str.release();
+    else
+        // another thread was faster
+        return *expected;
+}
+
+type_safe::optional_ref<const std::string> cpp_doc_comment_table::lookup(unsigned line) const
+{
+    auto iter = std::lower_bound(entries_.begin(), entries_.end(), line,
+                                 [](const entry& e, unsigned l) { return e.line < l; });
+    if (iter == entries_.end() || iter->line != line)
+        return type_safe::nullopt;
+    return type_safe::opt_ref(&text(std::size_t(iter - entries_.begin())));
+}
+
 cpp_entity_kind cpp_file::kind() noexcept
 {
     return cpp_entity_kind::file_t;
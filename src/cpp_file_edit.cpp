@@ -0,0 +1,112 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/cpp_file_edit.hpp>
+
+#include <cppast/detail/assert.hpp>
+
+using namespace cppast;
+
+namespace
+{
+bool is_child_of(const cpp_entity& entity, const cpp_file& file) noexcept
+{
+    for (auto cur = entity.parent(); cur; cur = cur.value().parent())
+        if (&cur.value() == &file)
+            return true;
+    return false;
+}
+
+void set_parent(cpp_entity& new_entity, const cpp_entity& entity)
+{
+    // the new entity takes the place of one next to the entity, so it has the same parent
+    detail::intrusive_list_access<cpp_entity>::on_insert(new_entity, entity.parent().value());
+}
+
+std::vector<type_safe::object_ref<const cpp_entity>> get_refs(
+    const std::vector<std::unique_ptr<cpp_entity>>& entities)
+{
+    std::vector<type_safe::object_ref<const cpp_entity>> result;
+    result.reserve(entities.size());
+    for (auto& e : entities)
+        result.push_back(type_safe::ref(*e));
+    return result;
+}
+} // namespace
+
+cpp_file_edit& cpp_file_edit::replace(const cpp_entity&           entity,
+                                      std::unique_ptr<cpp_entity> replacement)
+{
+    DEBUG_ASSERT(replacement != nullptr, detail::precondition_error_handler{},
+                 "replacement must not be null");
+    auto& c = get_change(entity);
+    set_parent(*replacement, entity);
+    c.replacement = std::move(replacement);
+    c.removed     = false;
+    return *this;
+}
+
+cpp_file_edit& cpp_file_edit::remove(const cpp_entity& entity)
+{
+    auto& c   = get_change(entity);
+    c.removed = true;
+    c.replacement.reset();
+    return *this;
+}
+
+cpp_file_edit& cpp_file_edit::insert_before(const cpp_entity&           entity,
+                                            std::unique_ptr<cpp_entity> new_entity)
+{
+    DEBUG_ASSERT(new_entity != nullptr, detail::precondition_error_handler{},
+                 "new entity must not be null");
+    auto& c = get_change(entity);
+    set_parent(*new_entity, entity);
+    c.before.push_back(std::move(new_entity));
+    return *this;
+}
+
+cpp_file_edit& cpp_file_edit::insert_after(const cpp_entity&           entity,
+                                           std::unique_ptr<cpp_entity> new_entity)
+{
+    DEBUG_ASSERT(new_entity != nullptr, detail::precondition_error_handler{},
+                 "new entity must not be null");
+    auto& c = get_change(entity);
+    set_parent(*new_entity, entity);
+    c.after.push_back(std::move(new_entity));
+    return *this;
+}
+
+type_safe::optional_ref<const cpp_entity> cpp_file_edit::lookup(
+    const cpp_entity& entity) const noexcept
+{
+    auto c = find_change(entity);
+    if (!c)
+        return type_safe::ref(entity);
+    else if (c->removed)
+        return nullptr;
+    else if (c->replacement)
+        return type_safe::ref(*c->replacement);
+    else
+        return type_safe::ref(entity);
+}
+
+std::vector<type_safe::object_ref<const cpp_entity>> cpp_file_edit::inserted_before(
+    const cpp_entity& entity) const
+{
+    auto c = find_change(entity);
+    return c ? get_refs(c->before) : std::vector<type_safe::object_ref<const cpp_entity>>();
+}
+
+std::vector<type_safe::object_ref<const cpp_entity>> cpp_file_edit::inserted_after(
+    const cpp_entity& entity) const
+{
+    auto c = find_change(entity);
+    return c ? get_refs(c->after) : std::vector<type_safe::object_ref<const cpp_entity>>();
+}
+
+auto cpp_file_edit::get_change(const cpp_entity& entity) -> change&
+{
+    DEBUG_ASSERT(is_child_of(entity, *file_), detail::precondition_error_handler{},
+                 "entity must be part of the edited file");
+    return changes_[&entity];
+}
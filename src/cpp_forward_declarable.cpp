@@ -89,6 +89,12 @@ bool cppast::is_definition(const cpp_entity& e) noexcept
     return declarable && declarable.value().is_definition();
 }
 
+std::string cppast::semantic_scope(const cpp_entity& e)
+{
+    auto declarable = get_declarable(e);
+    return declarable ? declarable.value().semantic_scope() : "";
+}
+
 type_safe::optional_ref<const cpp_entity> cppast::get_definition(const cpp_entity_index& idx,
                                                                  const cpp_entity&       e)
 {
@@ -10,7 +10,7 @@
 #include <cppast/cpp_entity_kind.hpp>
 #include <cppast/cpp_function_type.hpp>
 #include <cppast/cpp_template.hpp>
-#include <cppast/cpp_type_alias.hpp>
+#include <cppast/cpp_type_printer.hpp>
 
 using namespace cppast;
 
@@ -583,31 +583,5 @@ void detail::write_type(code_generator::output& output, const cpp_type& type, st
 
 std::string cppast::to_string(const cpp_type& type)
 {
-    class to_string_generator : public code_generator
-    {
-    public:
-        std::string get()
-        {
-            return std::move(result_);
-        }
-
-    private:
-        void do_indent() override {}
-
-        void do_unindent() override {}
-
-        void do_write_token_seq(string_view tokens) override
-        {
-            result_ += tokens.c_str();
-        }
-
-        std::string result_;
-    } generator;
-
-    // just a dummy type for the output
-    static auto dummy_entity = cpp_type_alias::build("foo", cpp_builtin_type::build(cpp_int));
-    to_string_generator::output output(type_safe::ref(generator), type_safe::ref(*dummy_entity),
-                                       cpp_public);
-    write_type(output, type, "");
-    return generator.get();
+    return cpp_type_printer().print(type);
 }
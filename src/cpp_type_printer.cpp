@@ -0,0 +1,386 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/cpp_type_printer.hpp>
+
+#include <cppast/cpp_array_type.hpp>
+#include <cppast/cpp_decltype_type.hpp>
+#include <cppast/cpp_expression.hpp>
+#include <cppast/cpp_function_type.hpp>
+#include <cppast/cpp_template.hpp>
+#include <cppast/cpp_template_parameter.hpp>
+
+using namespace cppast;
+
+namespace
+{
+// mirrors the functions in cpp_type.cpp and detail::write_token_string(),
+// but without any of the formatting whitespace, which isn't written by default
+class type_writer
+{
+public:
+    type_writer(std::string& buffer, cpp_type_printer::substitution subst, void* user_data,
+                cpp_type_printer::reference_callback reference, void* reference_data)
+    : buffer_(buffer),
+      substitution_(subst),
+      user_data_(user_data),
+      reference_(reference),
+      reference_data_(reference_data)
+    {}
+
+    void write_type(const cpp_type& type)
+    {
+        write_prefix(type);
+        write_suffix(type);
+    }
+
+private:
+    void write(string_view token)
+    {
+        if (substitution_)
+        {
+            if (auto replacement = substitution_(user_data_, token))
+            {
+                buffer_ += *replacement;
+                return;
+            }
+        }
+        buffer_.append(token.c_str(), token.length());
+    }
+
+    template <typename T, typename Predicate>
+    void write_reference(const basic_cpp_entity_ref<T, Predicate>& ref)
+    {
+        if (reference_)
+            reference_(reference_data_, ref.id(), ref.name());
+        write(ref.name());
+    }
+
+    static bool is_direct_complex(const cpp_type& type) noexcept
+    {
+        auto kind = type.kind();
+        return kind == cpp_type_kind::array_t || kind == cpp_type_kind::function_t
+               || kind == cpp_type_kind::member_function_t
+               || kind == cpp_type_kind::member_object_t;
+    }
+
+    static const cpp_type& strip_class_type(const cpp_type& type, cpp_cv& cv, cpp_reference& ref)
+    {
+        if (type.kind() == cpp_type_kind::cv_qualified_t)
+        {
+            auto& cv_qual = static_cast<const cpp_cv_qualified_type&>(type);
+            cv            = cv_qual.cv_qualifier();
+            return strip_class_type(cv_qual.type(), cv, ref);
+        }
+        else if (type.kind() == cpp_type_kind::reference_t)
+        {
+            auto& ref_type = static_cast<const cpp_reference_type&>(type);
+            ref            = ref_type.reference_kind();
+            return strip_class_type(ref_type.referee(), cv, ref);
+        }
+        else
+            return type;
+    }
+
+    void write_prefix(const cpp_type& type)
+    {
+        switch (type.kind())
+        {
+        case cpp_type_kind::builtin_t:
+            write(to_string(static_cast<const cpp_builtin_type&>(type).builtin_type_kind()));
+            break;
+        case cpp_type_kind::user_defined_t:
+            write_reference(static_cast<const cpp_user_defined_type&>(type).entity());
+            break;
+        case cpp_type_kind::auto_t:
+            write("auto");
+            break;
+        case cpp_type_kind::decltype_t:
+            write("decltype");
+            write("(");
+            write_expression(static_cast<const cpp_decltype_type&>(type).expression());
+            write(")");
+            break;
+        case cpp_type_kind::decltype_auto_t:
+            write("decltype");
+            write("(");
+            write("auto");
+            write(")");
+            break;
+
+        case cpp_type_kind::cv_qualified_t: {
+            auto& cv_type = static_cast<const cpp_cv_qualified_type&>(type);
+            write_prefix(cv_type.type());
+            if (is_direct_complex(cv_type.type()))
+                write("(");
+            if (is_const(cv_type.cv_qualifier()))
+            {
+                write(" ");
+                write("const");
+            }
+            if (is_volatile(cv_type.cv_qualifier()))
+            {
+                write(" ");
+                write("volatile");
+            }
+            break;
+        }
+        case cpp_type_kind::pointer_t: {
+            auto& pointee = static_cast<const cpp_pointer_type&>(type).pointee();
+            write_prefix(pointee);
+            if (pointee.kind() == cpp_type_kind::function_t
+                || pointee.kind() == cpp_type_kind::array_t)
+                write("(");
+            write("*");
+            break;
+        }
+        case cpp_type_kind::reference_t: {
+            auto& ref_type = static_cast<const cpp_reference_type&>(type);
+            write_prefix(ref_type.referee());
+            if (is_direct_complex(ref_type.referee()))
+                write("(");
+            if (ref_type.reference_kind() == cpp_ref_lvalue)
+                write("&");
+            else if (ref_type.reference_kind() == cpp_ref_rvalue)
+                write("&&");
+            break;
+        }
+
+        case cpp_type_kind::array_t:
+            write_prefix(static_cast<const cpp_array_type&>(type).value_type());
+            break;
+        case cpp_type_kind::function_t:
+            write_prefix(static_cast<const cpp_function_type&>(type).return_type());
+            break;
+        case cpp_type_kind::member_function_t: {
+            auto& func = static_cast<const cpp_member_function_type&>(type);
+            write_prefix(func.return_type());
+            write("(");
+            auto cv  = cpp_cv_none;
+            auto ref = cpp_ref_none;
+            write_prefix(strip_class_type(func.class_type(), cv, ref));
+            write("::");
+            break;
+        }
+        case cpp_type_kind::member_object_t: {
+            auto& obj = static_cast<const cpp_member_object_type&>(type);
+            write_prefix(obj.object_type());
+            write("(");
+            write_prefix(obj.class_type());
+            write("::");
+            break;
+        }
+
+        case cpp_type_kind::template_parameter_t:
+            write_reference(static_cast<const cpp_template_parameter_type&>(type).entity());
+            break;
+        case cpp_type_kind::template_instantiation_t:
+            write_template_instantiation(static_cast<const cpp_template_instantiation_type&>(type));
+            break;
+        case cpp_type_kind::dependent_t:
+            write(static_cast<const cpp_dependent_type&>(type).name());
+            break;
+        case cpp_type_kind::unexposed_t:
+            write(static_cast<const cpp_unexposed_type&>(type).name());
+            break;
+        }
+    }
+
+    void write_suffix(const cpp_type& type)
+    {
+        switch (type.kind())
+        {
+        case cpp_type_kind::cv_qualified_t: {
+            auto& cv_type = static_cast<const cpp_cv_qualified_type&>(type);
+            if (is_direct_complex(cv_type.type()))
+                write(")");
+            write_suffix(cv_type.type());
+            break;
+        }
+        case cpp_type_kind::pointer_t: {
+            auto& pointee = static_cast<const cpp_pointer_type&>(type).pointee();
+            if (pointee.kind() == cpp_type_kind::function_t
+                || pointee.kind() == cpp_type_kind::array_t)
+                write(")");
+            write_suffix(pointee);
+            break;
+        }
+        case cpp_type_kind::reference_t: {
+            auto& referee = static_cast<const cpp_reference_type&>(type).referee();
+            if (is_direct_complex(referee))
+                write(")");
+            write_suffix(referee);
+            break;
+        }
+
+        case cpp_type_kind::array_t: {
+            auto& array = static_cast<const cpp_array_type&>(type);
+            write("[");
+            if (array.size())
+                write_expression(array.size().value());
+            write("]");
+            write_suffix(array.value_type());
+            break;
+        }
+        case cpp_type_kind::function_t: {
+            auto& func = static_cast<const cpp_function_type&>(type);
+            write_parameters(func);
+            write_suffix(func.return_type());
+            break;
+        }
+        case cpp_type_kind::member_function_t: {
+            auto& func = static_cast<const cpp_member_function_type&>(type);
+            write(")");
+            write_parameters(func);
+
+            auto cv  = cpp_cv_none;
+            auto ref = cpp_ref_none;
+            strip_class_type(func.class_type(), cv, ref);
+            if (cv == cpp_cv_const_volatile)
+            {
+                write("const");
+                write(" ");
+                write("volatile");
+            }
+            else if (is_const(cv))
+                write("const");
+            else if (is_volatile(cv))
+                write("volatile");
+
+            if (ref == cpp_ref_lvalue)
+                write("&");
+            else if (ref == cpp_ref_rvalue)
+                write("&&");
+
+            write_suffix(func.return_type());
+            break;
+        }
+        case cpp_type_kind::member_object_t:
+            write(")");
+            break;
+
+        case cpp_type_kind::builtin_t:
+        case cpp_type_kind::user_defined_t:
+        case cpp_type_kind::auto_t:
+        case cpp_type_kind::decltype_t:
+        case cpp_type_kind::decltype_auto_t:
+        case cpp_type_kind::template_parameter_t:
+        case cpp_type_kind::template_instantiation_t:
+        case cpp_type_kind::dependent_t:
+        case cpp_type_kind::unexposed_t:
+            break;
+        }
+    }
+
+    template <typename T>
+    void write_parameters(const T& type)
+    {
+        write("(");
+
+        auto need_sep = false;
+        for (auto& param : type.parameter_types())
+        {
+            if (need_sep)
+                write(",");
+            else
+                need_sep = true;
+            write_type(param);
+        }
+        if (type.is_variadic())
+        {
+            if (need_sep)
+                write(",");
+            write("...");
+        }
+
+        write(")");
+    }
+
+    void write_template_instantiation(const cpp_template_instantiation_type& type)
+    {
+        write_reference(type.primary_template());
+        if (!type.arguments_exposed())
+        {
+            write("<");
+            write(type.unexposed_arguments());
+            write(">");
+        }
+        else if (auto arguments = type.arguments())
+        {
+            write("<");
+            auto need_sep = false;
+            for (auto& arg : arguments.value())
+            {
+                if (need_sep)
+                    write(",");
+                else
+                    need_sep = true;
+
+                if (auto arg_type = arg.type())
+                    write_type(arg_type.value());
+                else if (auto expr = arg.expression())
+                    write_expression(expr.value());
+                else if (auto templ = arg.template_ref())
+                    write_reference(templ.value());
+            }
+            write(">");
+        }
+        else
+        {
+            write("<");
+            write(">");
+        }
+    }
+
+    void write_expression(const cpp_expression& expr)
+    {
+        if (expr.kind() == cpp_expression_kind::literal_t)
+        {
+            write(static_cast<const cpp_literal_expression&>(expr).value());
+            return;
+        }
+
+        // separate consecutive identifiers and keywords, like detail::write_token_string()
+        auto last_kind = cpp_token_kind::punctuation;
+        for (auto& token : static_cast<const cpp_unexposed_expression&>(expr).expression())
+        {
+            if ((token.kind == cpp_token_kind::identifier || token.kind == cpp_token_kind::keyword)
+                && (last_kind == cpp_token_kind::identifier
+                    || last_kind == cpp_token_kind::keyword))
+                write(" ");
+            write(token.spelling);
+            last_kind = token.kind;
+        }
+    }
+
+    std::string&                         buffer_;
+    cpp_type_printer::substitution       substitution_;
+    void*                                user_data_;
+    cpp_type_printer::reference_callback reference_;
+    void*                                reference_data_;
+};
+} // namespace
+
+void cpp_type_printer::write(std::string& buffer, const cpp_type& type)
+{
+    if (!use_cache_ || reference_callback_)
+    {
+        write_uncached(buffer, type);
+        return;
+    }
+
+    auto iter = cache_.find(&type);
+    if (iter == cache_.end())
+    {
+        std::string result;
+        write_uncached(result, type);
+        iter = cache_.emplace(&type, std::move(result)).first;
+    }
+    buffer += iter->second;
+}
+
+void cpp_type_printer::write_uncached(std::string& buffer, const cpp_type& type)
+{
+    type_writer(buffer, substitution_, user_data_, reference_callback_, reference_data_)
+        .write_type(type);
+}
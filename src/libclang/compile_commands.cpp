@@ -0,0 +1,366 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include "compile_commands.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <cppast/libclang_parser.hpp>
+
+using namespace cppast;
+
+namespace
+{
+// mirrors the CommandLineArgumentParser of clang's JSONCompilationDatabase
+class command_line_splitter
+{
+public:
+    explicit command_line_splitter(const std::string& command)
+    : cur_(command.c_str()), end_(command.c_str() + command.size())
+    {}
+
+    std::vector<std::string> split()
+    {
+        std::vector<std::string> result;
+        skip_whitespace();
+        while (cur_ != end_)
+        {
+            std::string arg;
+            while (cur_ != end_ && *cur_ != ' ')
+            {
+                if (*cur_ == '"')
+                    parse_quoted(arg, '"', true);
+                else if (*cur_ == '\'')
+                    parse_quoted(arg, '\'', false);
+                else
+                    parse_free(arg);
+            }
+            result.push_back(std::move(arg));
+            skip_whitespace();
+        }
+        return result;
+    }
+
+private:
+    void skip_whitespace() noexcept
+    {
+        while (cur_ != end_ && *cur_ == ' ')
+            ++cur_;
+    }
+
+    void skip_escape() noexcept
+    {
+        if (*cur_ == '\\' && cur_ + 1 != end_)
+            ++cur_;
+    }
+
+    void parse_quoted(std::string& arg, char quote, bool allow_escape)
+    {
+        ++cur_;
+        while (cur_ != end_ && *cur_ != quote)
+        {
+            if (allow_escape)
+                skip_escape();
+            arg += *cur_++;
+        }
+        if (cur_ != end_)
+            ++cur_;
+    }
+
+    void parse_free(std::string& arg)
+    {
+        do
+        {
+            skip_escape();
+            arg += *cur_++;
+        } while (cur_ != end_ && *cur_ != ' ' && *cur_ != '"' && *cur_ != '\'');
+    }
+
+    const char* cur_;
+    const char* end_;
+};
+
+// a parser for the subset of JSON used by compile_commands.json,
+// it accepts trailing commas like libclang does
+class json_parser
+{
+public:
+    explicit json_parser(const std::string& buffer)
+    : begin_(buffer.c_str()), cur_(buffer.c_str()), end_(buffer.c_str() + buffer.size())
+    {}
+
+    void parse(void* user_data, void (*callback)(void*, detail::compile_command&&))
+    {
+        expect('[');
+        while (!consume(']'))
+        {
+            callback(user_data, parse_command());
+            if (!consume(','))
+            {
+                expect(']');
+                break;
+            }
+        }
+
+        skip_whitespace();
+        if (cur_ != end_)
+            error("unexpected characters after array");
+    }
+
+private:
+    detail::compile_command parse_command()
+    {
+        detail::compile_command result;
+        auto                    has_arguments = false;
+        std::string             command;
+
+        expect('{');
+        while (!consume('}'))
+        {
+            auto key = parse_string();
+            expect(':');
+            if (key == "directory")
+                result.directory = parse_string();
+            else if (key == "file")
+                result.file = parse_string();
+            else if (key == "command")
+                command = parse_string();
+            else if (key == "arguments")
+            {
+                has_arguments = true;
+                expect('[');
+                while (!consume(']'))
+                {
+                    result.arguments.push_back(parse_string());
+                    if (!consume(','))
+                    {
+                        expect(']');
+                        break;
+                    }
+                }
+            }
+            else
+                skip_value();
+
+            if (!consume(','))
+            {
+                expect('}');
+                break;
+            }
+        }
+
+        if (!has_arguments)
+            result.arguments = detail::split_command_line(command);
+        return result;
+    }
+
+    std::string parse_string()
+    {
+        expect('"');
+
+        std::string result;
+        while (true)
+        {
+            if (cur_ == end_)
+                error("unterminated string");
+
+            auto c = *cur_++;
+            if (c == '"')
+                break;
+            else if (c != '\\')
+                result += c;
+            else if (cur_ == end_)
+                error("unterminated string");
+            else
+            {
+                switch (*cur_++)
+                {
+                case '"':
+                    result += '"';
+                    break;
+                case '\\':
+                    result += '\\';
+                    break;
+                case '/':
+                    result += '/';
+                    break;
+                case 'b':
+                    result += '\b';
+                    break;
+                case 'f':
+                    result += '\f';
+                    break;
+                case 'n':
+                    result += '\n';
+                    break;
+                case 'r':
+                    result += '\r';
+                    break;
+                case 't':
+                    result += '\t';
+                    break;
+                case 'u':
+                    append_code_point(result, parse_code_point());
+                    break;
+                default:
+                    error("invalid escape sequence");
+                }
+            }
+        }
+        return result;
+    }
+
+    std::uint_least32_t parse_hex4()
+    {
+        if (end_ - cur_ < 4)
+            error("invalid unicode escape sequence");
+
+        auto result = std::uint_least32_t(0u);
+        for (auto i = 0; i != 4; ++i)
+        {
+            auto c = *cur_++;
+            result <<= 4u;
+            if (c >= '0' && c <= '9')
+                result |= std::uint_least32_t(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                result |= std::uint_least32_t(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                result |= std::uint_least32_t(c - 'A' + 10);
+            else
+                error("invalid unicode escape sequence");
+        }
+        return result;
+    }
+
+    std::uint_least32_t parse_code_point()
+    {
+        auto code_point = parse_hex4();
+        if (code_point >= 0xD800u && code_point <= 0xDBFFu && end_ - cur_ >= 6 && cur_[0] == '\\'
+            && cur_[1] == 'u')
+        {
+            // surrogate pair
+            cur_ += 2;
+            auto low = parse_hex4();
+            if (low < 0xDC00u || low > 0xDFFFu)
+                error("invalid surrogate pair");
+            code_point = 0x10000u + ((code_point - 0xD800u) << 10u) + (low - 0xDC00u);
+        }
+        return code_point;
+    }
+
+    static void append_code_point(std::string& str, std::uint_least32_t code_point)
+    {
+        // UTF-8
+        if (code_point < 0x80u)
+            str += char(code_point);
+        else if (code_point < 0x800u)
+        {
+            str += char(0xC0u | (code_point >> 6u));
+            str += char(0x80u | (code_point & 0x3Fu));
+        }
+        else if (code_point < 0x10000u)
+        {
+            str += char(0xE0u | (code_point >> 12u));
+            str += char(0x80u | ((code_point >> 6u) & 0x3Fu));
+            str += char(0x80u | (code_point & 0x3Fu));
+        }
+        else
+        {
+            str += char(0xF0u | (code_point >> 18u));
+            str += char(0x80u | ((code_point >> 12u) & 0x3Fu));
+            str += char(0x80u | ((code_point >> 6u) & 0x3Fu));
+            str += char(0x80u | (code_point & 0x3Fu));
+        }
+    }
+
+    // skips values of other keys, they can be any JSON value
+    void skip_value()
+    {
+        skip_whitespace();
+        if (cur_ == end_)
+            error("unexpected end of file");
+        else if (*cur_ == '"')
+            parse_string();
+        else if (*cur_ == '[' || *cur_ == '{')
+        {
+            auto close = *cur_ == '[' ? ']' : '}';
+            ++cur_;
+            while (!consume(close))
+            {
+                if (close == '}')
+                {
+                    parse_string();
+                    expect(':');
+                }
+                skip_value();
+                if (!consume(','))
+                {
+                    expect(close);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            // number, true, false or null
+            auto begin = cur_;
+            while (cur_ != end_ && std::strchr(",]} \t\r\n", *cur_) == nullptr)
+                ++cur_;
+            if (begin == cur_)
+                error("expected value");
+        }
+    }
+
+    void skip_whitespace() noexcept
+    {
+        while (cur_ != end_ && (*cur_ == ' ' || *cur_ == '\t' || *cur_ == '\r' || *cur_ == '\n'))
+            ++cur_;
+    }
+
+    bool consume(char c) noexcept
+    {
+        skip_whitespace();
+        if (cur_ == end_ || *cur_ != c)
+            return false;
+        ++cur_;
+        return true;
+    }
+
+    void expect(char c)
+    {
+        if (!consume(c))
+            error(std::string("expected '") + c + "'");
+    }
+
+    [[noreturn]] void error(const std::string& msg) const
+    {
+        throw libclang_error(detail::format("unable to parse compilation database: ", msg,
+                                            " at offset ", cur_ - begin_));
+    }
+
+    const char* begin_;
+    const char* cur_;
+    const char* end_;
+};
+} // namespace
+
+std::vector<std::string> detail::split_command_line(const std::string& command)
+{
+    return command_line_splitter(command).split();
+}
+
+void detail::read_compile_commands(const std::string& path, void* user_data,
+                                   void (*callback)(void*, compile_command&&))
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw libclang_error("unable to load compilation database");
+
+    // read the entire file at once
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    json_parser(stream.str()).parse(user_data, callback);
+}
@@ -0,0 +1,30 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_COMPILE_COMMANDS_HPP_INCLUDED
+#define CPPAST_COMPILE_COMMANDS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+namespace cppast
+{
+namespace detail
+{
+    struct compile_command
+    {
+        std::string              directory, file;
+        std::vector<std::string> arguments; // including the compiler
+    };
+
+    // splits the command line like libclang's JSON compilation database does
+    std::vector<std::string> split_command_line(const std::string& command);
+
+    // reads the compile_commands.json file and invokes the callback for every command,
+    // throws libclang_error if it can't be read or parsed
+    void read_compile_commands(const std::string& path, void* user_data,
+                               void (*callback)(void*, compile_command&&));
+} // namespace detail
+} // namespace cppast
+
+#endif // CPPAST_COMPILE_COMMANDS_HPP_INCLUDED
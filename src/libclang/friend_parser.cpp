@@ -16,7 +16,7 @@ std::unique_ptr<cpp_entity> detail::parse_cpp_friend(const detail::parse_context
 {
     DEBUG_ASSERT(clang_getCursorKind(cur) == CXCursor_FriendDecl, detail::assert_handler{});
 
-    std::string                                                   comment;
+    std::uint_least32_t                                           comment = 0u;
     std::unique_ptr<cpp_entity>                                   entity;
     std::unique_ptr<cpp_type>                                     type;
     std::string                                                   namespace_str;
@@ -53,7 +53,7 @@ std::unique_ptr<cpp_entity> detail::parse_cpp_friend(const detail::parse_context
                 // we actually need a class decl cursor, so parse the referenced one
                 // this might be a definition, so give friend information to the parser
                 entity  = parse_entity(context, nullptr, referenced, cur);
-                comment = type_safe::copy(entity->comment()).value_or("");
+                comment = detail::cpp_doc_comment_access::get(*entity);
             }
         }
         else if (kind == CXCursor_NamespaceRef)
@@ -76,8 +76,8 @@ std::unique_ptr<cpp_entity> detail::parse_cpp_friend(const detail::parse_context
             if (entity)
             {
                 // steal comment
-                comment = type_safe::copy(entity->comment()).value_or("");
-                entity->set_comment(type_safe::nullopt);
+                comment = detail::cpp_doc_comment_access::get(*entity);
+                detail::cpp_doc_comment_access::set(*entity, 0u);
             }
         }
         else if (inst_builder && clang_isExpression(kind))
@@ -97,9 +97,9 @@ std::unique_ptr<cpp_entity> detail::parse_cpp_friend(const detail::parse_context
     else
         DEBUG_UNREACHABLE(detail::parse_error_handler{}, cur,
                           "unknown child entity of friend declaration");
-    if (!comment.empty())
+    if (comment != 0u)
         // set comment of entity...
-        result->set_comment(std::move(comment));
+        detail::cpp_doc_comment_access::set(*result, comment);
     // ... but override if this finds a different comment
     // due to clang_getCursorReferenced(), this may happen
     context.comments.match(*result, cur);
@@ -3,13 +3,21 @@
 
 #include <cppast/libclang_parser.hpp>
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <clang-c/CXCompilationDatabase.h>
 #include <process.hpp>
 
+#include "compile_commands.hpp"
 #include "cxtokenizer.hpp"
 #include "libclang_visitor.hpp"
 #include "parse_error.hpp"
@@ -113,17 +121,17 @@ bool is_absolute(const std::string& file)
     return !file.empty() && (has_drive_prefix(file) || file.front() == '/' || file.front() == '\\');
 }
 
-std::string get_full_path(const detail::cxstring& dir, const std::string& file)
+std::string get_full_path(const std::string& dir, const std::string& file)
 {
-    if (is_absolute(file))
+    if (is_absolute(file) || dir.empty())
         // absolute file
         return file;
-    else if (dir[dir.length() - 1] != '/' && dir[dir.length() - 1] != '\\')
+    else if (dir.back() != '/' && dir.back() != '\\')
         // relative needing separator
-        return dir.std_str() + '/' + file;
+        return dir + '/' + file;
     else
         // relative w/o separator
-        return dir.std_str() + file;
+        return dir + file;
 }
 } // namespace
 
@@ -137,7 +145,7 @@ void detail::for_each_file(const libclang_compilation_database& database, void*
     {
         auto cmd = clang_CompileCommands_getCommand(commands.get(), i);
 
-        auto dir = cxstring(clang_CompileCommand_getDirectory(cmd));
+        auto dir = cxstring(clang_CompileCommand_getDirectory(cmd)).std_str();
         callback(user_data,
                  get_full_path(dir, cxstring(clang_CompileCommand_getFilename(cmd)).std_str()));
     }
@@ -145,7 +153,7 @@ void detail::for_each_file(const libclang_compilation_database& database, void*
 
 namespace
 {
-bool is_flag(const detail::cxstring& str)
+bool is_flag(const std::string& str)
 {
     return str.length() > 1u && str[0] == '-';
 }
@@ -158,14 +166,24 @@ const char* find_flag_arg_sep(const std::string& last_flag)
     return std::strchr(last_flag.c_str(), '=');
 }
 
+std::vector<std::string> get_arguments(CXCompileCommand cmd)
+{
+    std::vector<std::string> result;
+
+    auto no_args = clang_CompileCommand_getNumArgs(cmd);
+    result.reserve(no_args);
+    for (auto i = 0u; i != no_args; ++i)
+        result.push_back(detail::cxstring(clang_CompileCommand_getArg(cmd, i)).std_str());
+    return result;
+}
+
 template <typename Func>
-void parse_flags(CXCompileCommand cmd, Func callback)
+void parse_flags(const std::vector<std::string>& arguments, Func callback)
 {
-    auto        no_args = clang_CompileCommand_getNumArgs(cmd);
     std::string last_flag;
-    for (auto i = 1u /* 0 is compiler executable */; i != no_args; ++i)
+    for (auto i = 1u /* 0 is compiler executable */; i < arguments.size(); ++i)
     {
-        detail::cxstring str(clang_CompileCommand_getArg(cmd, i));
+        auto& str = arguments[i];
         if (is_flag(str))
         {
             if (!last_flag.empty())
@@ -190,17 +208,45 @@ void parse_flags(CXCompileCommand cmd, Func callback)
                 callback(std::move(last_flag), std::move(args));
             }
 
-            last_flag = str.std_str();
+            last_flag = str;
         }
         else if (!last_flag.empty())
         {
             // we have flags + args
-            callback(std::move(last_flag), str.std_str());
+            callback(std::move(last_flag), str);
             last_flag.clear();
         }
         // else skip argument
     }
 }
+
+// invokes add_flag for the flags of the command that are used by the config
+template <typename Func>
+void add_flags(const std::string& dir, const std::vector<std::string>& arguments, Func add_flag)
+{
+    parse_flags(arguments, [&](std::string flag, std::string args) {
+        if (flag == "-I")
+            add_flag(std::move(flag) + get_full_path(dir, args));
+        else if (flag == "-isystem")
+            add_flag(std::move(flag) + get_full_path(dir, args));
+        else if (flag == "-D" || flag == "-U")
+        {
+            // preprocessor options
+            for (auto c : args)
+                if (c == '"')
+                    flag += "\\\"";
+                else
+                    flag += c;
+            add_flag(std::move(flag));
+        }
+        else if (flag == "-std")
+            // standard
+            add_flag(std::move(flag) + "=" + std::move(args));
+        else if (flag == "-f")
+            // other options
+            add_flag(std::move(flag) + std::move(args));
+    });
+}
 } // namespace
 
 libclang_compile_config::libclang_compile_config(const libclang_compilation_database& database,
@@ -217,32 +263,104 @@ libclang_compile_config::libclang_compile_config(const libclang_compilation_data
     for (auto i = 0u; i != size; ++i)
     {
         auto cmd = clang_CompileCommands_getCommand(commands.get(), i);
-        auto dir = detail::cxstring(clang_CompileCommand_getDirectory(cmd));
-        parse_flags(cmd, [&](std::string flag, std::string args) {
-            if (flag == "-I")
-                add_flag(std::move(flag) + get_full_path(dir, args));
-            else if (flag == "-isystem")
-                add_flag(std::move(flag) + get_full_path(dir, args));
-            else if (flag == "-D" || flag == "-U")
-            {
-                // preprocessor options
-                for (auto c : args)
-                    if (c == '"')
-                        flag += "\\\"";
-                    else
-                        flag += c;
-                add_flag(std::move(flag));
-            }
-            else if (flag == "-std")
-                // standard
-                add_flag(std::move(flag) + "=" + std::move(args));
-            else if (flag == "-f")
-                // other options
-                add_flag(std::move(flag) + std::move(args));
-        });
+        auto dir = detail::cxstring(clang_CompileCommand_getDirectory(cmd)).std_str();
+        add_flags(dir, get_arguments(cmd), [&](std::string flag) { add_flag(std::move(flag)); });
     }
 }
 
+namespace
+{
+bool is_separator(char c) noexcept
+{
+    return c == '/' || c == '\\';
+}
+
+// removes . and .. components and duplicate separators,
+// so that different spellings of the same path are found
+std::string normalize_path(const std::string& path)
+{
+    auto cur    = path.begin();
+    auto prefix = std::string();
+    if (has_drive_prefix(path))
+    {
+        prefix.append(cur, cur + 2);
+        cur += 2;
+    }
+    auto root = cur != path.end() && is_separator(*cur);
+    if (root)
+        prefix += '/';
+
+    std::vector<std::string> components;
+    while (cur != path.end())
+    {
+        auto end = std::find_if(cur, path.end(), is_separator);
+
+        std::string component(cur, end);
+        if (component.empty() || component == ".")
+            ; // skip
+        else if (component != "..")
+            components.push_back(std::move(component));
+        else if (!components.empty() && components.back() != "..")
+            components.pop_back();
+        else if (!root)
+            // can only go above a relative path
+            components.push_back(std::move(component));
+
+        cur = end == path.end() ? end : end + 1;
+    }
+
+    auto result = std::move(prefix);
+    for (auto& component : components)
+    {
+        if (&component != &components.front())
+            result += '/';
+        result += component;
+    }
+    return result;
+}
+} // namespace
+
+json_compilation_database::json_compilation_database(const std::string& build_directory)
+{
+    detail::read_compile_commands(
+        get_full_path(build_directory, "compile_commands.json"), this,
+        [](void* ptr, detail::compile_command&& cmd) {
+            auto& database  = *static_cast<json_compilation_database*>(ptr);
+            auto  full_path = get_full_path(cmd.directory, cmd.file);
+
+            auto& flags = database.commands_[normalize_path(full_path)];
+            add_flags(cmd.directory, cmd.arguments, [&](std::string flag) {
+                // the same flags are repeated for most files, so only store them once
+                flags.push_back(&*database.strings_.insert(std::move(flag)).first);
+            });
+
+            database.files_.push_back(std::move(full_path));
+        });
+}
+
+bool json_compilation_database::has_config(const char* file_name) const
+{
+    return find(file_name) != nullptr;
+}
+
+const std::vector<const std::string*>* json_compilation_database::find(const char* file_name) const
+{
+    auto iter = commands_.find(normalize_path(file_name));
+    return iter == commands_.end() ? nullptr : &iter->second;
+}
+
+libclang_compile_config::libclang_compile_config(const json_compilation_database& database,
+                                                 const std::string&               file)
+: libclang_compile_config(database.default_config_)
+{
+    auto flags = database.find(file.c_str());
+    if (flags == nullptr)
+        throw libclang_error(detail::format("no compile commands specified for file '", file, "'"));
+
+    for (auto flag : *flags)
+        add_flag(*flag);
+}
+
 namespace
 {
 bool is_valid_binary(const std::string& binary)
@@ -443,8 +561,11 @@ void libclang_compile_config::do_remove_macro_definition(std::string name)
     add_flag("-U" + std::move(name));
 }
 
-type_safe::optional<libclang_compile_config> cppast::find_config_for(
-    const libclang_compilation_database& database, std::string file_name)
+namespace
+{
+template <class Database>
+type_safe::optional<libclang_compile_config> find_config_for_impl(const Database& database,
+                                                                  std::string     file_name)
 {
     if (database.has_config(file_name))
         return libclang_compile_config(database, std::move(file_name));
@@ -466,6 +587,19 @@ type_safe::optional<libclang_compile_config> cppast::find_config_for(
 
     return type_safe::nullopt;
 }
+} // namespace
+
+type_safe::optional<libclang_compile_config> cppast::find_config_for(
+    const libclang_compilation_database& database, std::string file_name)
+{
+    return find_config_for_impl(database, std::move(file_name));
+}
+
+type_safe::optional<libclang_compile_config> cppast::find_config_for(
+    const json_compilation_database& database, std::string file_name)
+{
+    return find_config_for_impl(database, std::move(file_name));
+}
 
 int cppast::libclang_parser::libclang_minor_version()
 {
@@ -543,13 +677,11 @@ void print_diagnostics(const diagnostic_logger& logger, const CXTranslationUnit&
 }
 
 detail::cxtranslation_unit get_cxunit(const diagnostic_logger& logger, const detail::cxindex& idx,
-                                      const libclang_compile_config& config, const char* path,
+                                      const std::vector<const char*>& args, const char* path,
                                       const std::string& source)
 {
     CXUnsavedFile file{path, source.c_str(), static_cast<unsigned long>(source.length())};
 
-    auto args = get_arguments(config);
-
     CXTranslationUnit tu;
     auto              flags = CXTranslationUnit_Incomplete | CXTranslationUnit_KeepGoing
                  | CXTranslationUnit_DetailedPreprocessingRecord;
@@ -592,37 +724,180 @@ unsigned get_line_no(const CXCursor& cursor)
     return line;
 }
 } // namespace
-std::unique_ptr<cpp_file> libclang_parser::do_parse(const cpp_entity_index& idx, std::string path,
-                                                    const compile_config& c) const
-try
+
+namespace
 {
-    DEBUG_ASSERT(std::strcmp(c.name(), "libclang") == 0, detail::precondition_error_handler{},
-                 "config has mismatched type");
-    auto& config = static_cast<const libclang_compile_config&>(c);
+// FNV-1a, it doesn't depend on the standard library implementation
+class fingerprint_hasher
+{
+public:
+    void add(const std::string& str) noexcept
+    {
+        for (auto c : str)
+            add_byte(static_cast<unsigned char>(c));
+        // separate the strings, so "ab" "c" and "a" "bc" differ
+        add_byte(0u);
+    }
+
+    void add(bool b) noexcept
+    {
+        add_byte(static_cast<unsigned char>(b ? 1 : 0));
+    }
+
+    std::uint_least64_t finish() const noexcept
+    {
+        return hash_;
+    }
+
+private:
+    void add_byte(unsigned char byte) noexcept
+    {
+        hash_ ^= std::uint_least64_t(byte);
+        hash_ = (hash_ * 0x100000001b3ull) & 0xffffffffffffffffull;
+    }
+
+    std::uint_least64_t hash_ = 0xcbf29ce484222325ull;
+};
+} // namespace
+
+struct libclang_shared_config::data
+{
+    libclang_compile_config  config;
+    std::vector<const char*> arguments;
+    std::uint_least64_t      fingerprint;
+
+    explicit data(libclang_compile_config c)
+    : config(std::move(c)), arguments(get_arguments(config))
+    {
+        using access = detail::libclang_compile_config_access;
+
+        fingerprint_hasher hasher;
+        hasher.add(access::clang_binary(config));
+        for (auto& flag : access::flags(config))
+            hasher.add(flag);
+        hasher.add(access::write_preprocessed(config));
+        hasher.add(access::fast_preprocessing(config));
+        hasher.add(access::remove_comments_in_macro(config));
+        fingerprint = hasher.finish();
+    }
+
+    bool equal(const data& other) const
+    {
+        using access = detail::libclang_compile_config_access;
+        return fingerprint == other.fingerprint
+               && access::clang_binary(config) == access::clang_binary(other.config)
+               && access::flags(config) == access::flags(other.config)
+               && access::write_preprocessed(config) == access::write_preprocessed(other.config)
+               && access::fast_preprocessing(config) == access::fast_preprocessing(other.config)
+               && access::remove_comments_in_macro(config)
+                      == access::remove_comments_in_macro(other.config);
+    }
+};
+
+libclang_shared_config::libclang_shared_config(libclang_compile_config config)
+: data_(std::make_shared<const data>(std::move(config)))
+{}
+
+libclang_shared_config libclang_shared_config::intern(const libclang_compile_config& config)
+{
+    // the snapshots that still have handles, by fingerprint
+    static std::mutex mutex;
+    static std::unordered_map<std::uint_least64_t, std::vector<std::weak_ptr<const data>>>
+        snapshots;
+
+    // not make_shared(), the weak_ptrs would keep the memory of the snapshot alive
+    std::shared_ptr<const data> result(new data(config));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // forget the snapshots without handles, so distinct configs don't accumulate
+    auto expired = [](const std::weak_ptr<const data>& ptr) { return ptr.expired(); };
+    for (auto iter = snapshots.begin(); iter != snapshots.end();)
+    {
+        auto& ptrs = iter->second;
+        ptrs.erase(std::remove_if(ptrs.begin(), ptrs.end(), expired), ptrs.end());
+        if (ptrs.empty())
+            iter = snapshots.erase(iter);
+        else
+            ++iter;
+    }
+
+    auto& bucket = snapshots[result->fingerprint];
+    for (auto& ptr : bucket)
+    {
+        auto existing = ptr.lock();
+        if (existing && existing->equal(*result))
+            return libclang_shared_config(std::move(existing));
+    }
+
+    bucket.push_back(result);
+    return libclang_shared_config(std::move(result));
+}
 
-    // preprocess
-    auto preprocessed = detail::preprocess(config, path.c_str(), logger());
+const libclang_compile_config& libclang_shared_config::config() const noexcept
+{
+    return data_->config;
+}
+
+const std::vector<const char*>& libclang_shared_config::arguments() const noexcept
+{
+    return data_->arguments;
+}
+
+std::uint_least64_t libclang_shared_config::fingerprint() const noexcept
+{
+    return data_->fingerprint;
+}
+
+namespace cppast
+{
+bool operator==(const libclang_shared_config& a, const libclang_shared_config& b) noexcept
+{
+    return a.data_ == b.data_ || a.data_->equal(*b.data_);
+}
+} // namespace cppast
+
+namespace
+{
+detail::preprocessor_output preprocess_file(const libclang_compile_config& config,
+                                            const std::string&             path,
+                                            const diagnostic_logger&       logger)
+{
+    auto preprocessed = detail::preprocess(config, path.c_str(), logger);
     if (detail::libclang_compile_config_access::write_preprocessed(config))
     {
         std::ofstream file(path + ".pp");
         file << preprocessed.source;
     }
+    return preprocessed;
+}
+
+// converts the entities of the translation unit, error is set if the AST is incomplete
+std::unique_ptr<cpp_file> convert_file(const cpp_entity_index&           idx,
+                                       const std::string&                path,
+                                       const diagnostic_logger&          logger,
+                                       const detail::cxtranslation_unit& tu,
+                                       detail::preprocessor_output&      preprocessed,
+                                       bool&                             error)
+{
+    cpp_entity_index::id_verification verification(idx);
 
-    // parse
-    auto tu   = get_cxunit(logger(), pimpl_->index, config, path.c_str(), preprocessed.source);
     auto file = clang_getFile(tu.get(), path.c_str());
 
     cpp_file::builder builder(detail::cxstring(clang_getFileName(file)).std_str());
     auto              macro_iter   = preprocessed.macros.begin();
     auto              include_iter = preprocessed.includes.begin();
 
+    // the entities of the file are registered all at once when it is finished
+    cpp_entity_index::registration_batch registrations(idx);
+
     // convert entity hierarchies
     detail::parse_context context{tu.get(),
                                   file,
-                                  type_safe::ref(logger()),
+                                  type_safe::ref(logger),
                                   type_safe::ref(idx),
                                   detail::comment_context(preprocessed.comments),
-                                  false};
+                                  false,
+                                  {}};
     detail::visit_tu(tu, path.c_str(), [&](const CXCursor& cur) {
         if (clang_getCursorKind(cur) == CXCursor_InclusionDirective)
         {
@@ -674,20 +949,235 @@ try
     for (; macro_iter != preprocessed.macros.end(); ++macro_iter)
         builder.add_child(std::move(macro_iter->macro));
 
+    // matched entities refer to the comment table by index, so keep every comment in there
+    std::vector<cpp_doc_comment_table::entry> comments;
+    comments.reserve(preprocessed.comments.size());
     for (auto& cur : preprocessed.comments)
     {
-        if (!cur.comment.empty())
-            builder.add_unmatched_comment(cpp_doc_comment(std::move(cur.comment), cur.line));
+        comments.emplace_back(cur.offset, cur.size, cur.line);
+        if (!cur.matched && cur.size != 0u)
+            builder.add_unmatched_comment(
+                cpp_doc_comment(preprocessed.comment_buffer.substr(cur.offset, cur.size),
+                                cur.line));
     }
+    builder.set_comment_table(
+        cpp_doc_comment_table(std::move(preprocessed.comment_buffer), std::move(comments)));
 
-    if (context.error)
-        set_error();
-
+    error = context.error;
+    idx.register_batch(registrations);
     return builder.finish(idx);
 }
+
+// a bounded queue between two stages of parse_pipelined()
+template <typename T>
+class stage_queue
+{
+public:
+    explicit stage_queue(std::size_t capacity) : capacity_(capacity), closed_(false) {}
+
+    // blocks while the queue is full, returns false if the queue was closed
+    bool push(T value)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return closed_ || queue_.size() < capacity_; });
+        if (closed_)
+            return false;
+
+        queue_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // blocks while the queue is empty, returns false if it is empty and closed
+    bool pop(T& value)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return closed_ || !queue_.empty(); });
+        if (queue_.empty())
+            return false;
+
+        value = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // no more values can be pushed, but the remaining ones can still be popped
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    std::mutex              mutex_;
+    std::condition_variable not_full_, not_empty_;
+    std::deque<T>           queue_;
+    std::size_t             capacity_;
+    bool                    closed_;
+};
+
+// a file passed between the stages of parse_pipelined()
+struct pipeline_file
+{
+    detail::preprocessor_output                 preprocessed;
+    std::unique_ptr<detail::cxtranslation_unit> tu;
+    // any exception other than a parse error, rethrown in the calling thread
+    std::exception_ptr exception;
+    // a parse error that was already logged
+    bool failed = false;
+};
+} // namespace
+
+std::unique_ptr<cpp_file> libclang_parser::do_parse(const cpp_entity_index& idx, std::string path,
+                                                    const compile_config& c) const
+{
+    DEBUG_ASSERT(std::strcmp(c.name(), "libclang") == 0, detail::precondition_error_handler{},
+                 "config has mismatched type");
+    auto& config = static_cast<const libclang_compile_config&>(c);
+    return parse_impl(idx, path, config, get_arguments(config));
+}
+
+std::unique_ptr<cpp_file> libclang_parser::parse(const cpp_entity_index& idx, std::string path,
+                                                 const libclang_shared_config& config) const
+{
+    return parse_impl(idx, path, config.config(), config.arguments());
+}
+
+std::unique_ptr<cpp_file> libclang_parser::parse_impl(const cpp_entity_index&         idx,
+                                                      const std::string&              path,
+                                                      const libclang_compile_config&  config,
+                                                      const std::vector<const char*>& args) const
+try
+{
+    auto preprocessed = preprocess_file(config, path, logger());
+    auto tu = get_cxunit(logger(), pimpl_->index, args, path.c_str(), preprocessed.source);
+
+    auto error  = false;
+    auto result = convert_file(idx, path, logger(), tu, preprocessed, error);
+    if (error)
+        set_error();
+    return result;
+}
 catch (detail::parse_error& ex)
 {
     logger().log("libclang parser", ex.get_diagnostic(path));
     set_error();
     return nullptr;
 }
+
+std::vector<std::unique_ptr<cpp_file>> libclang_parser::parse_pipelined(
+    const cpp_entity_index& idx, const std::vector<std::string>& paths,
+    const libclang_shared_config& config, std::size_t queue_size) const
+{
+    auto& c = config.config();
+
+    stage_queue<pipeline_file> preprocessed_queue(std::max(queue_size, std::size_t(1u)));
+    stage_queue<pipeline_file> parsed_queue(std::max(queue_size, std::size_t(1u)));
+
+    // must be called in a catch block
+    auto handle_exception = [&](const std::string& path, pipeline_file& f) {
+        try
+        {
+            throw;
+        }
+        catch (detail::parse_error& ex)
+        {
+            logger().log("libclang parser", ex.get_diagnostic(path));
+            set_error();
+            f.failed = true;
+        }
+        catch (...)
+        {
+            f.exception = std::current_exception();
+        }
+    };
+
+    std::thread preprocessor([&] {
+        for (auto& path : paths)
+        {
+            pipeline_file f;
+            try
+            {
+                f.preprocessed = preprocess_file(c, path, logger());
+            }
+            catch (...)
+            {
+                handle_exception(path, f);
+            }
+
+            if (!preprocessed_queue.push(std::move(f)))
+                break;
+        }
+        preprocessed_queue.close();
+    });
+
+    std::thread parser([&] {
+        pipeline_file f;
+        for (auto i = std::size_t(0u); preprocessed_queue.pop(f); ++i)
+        {
+            if (!f.failed && !f.exception)
+            {
+                try
+                {
+                    f.tu.reset(new detail::cxtranslation_unit(
+                        get_cxunit(logger(), pimpl_->index, config.arguments(), paths[i].c_str(),
+                                   f.preprocessed.source)));
+                }
+                catch (...)
+                {
+                    handle_exception(paths[i], f);
+                }
+            }
+
+            if (!parsed_queue.push(std::move(f)))
+                break;
+        }
+        parsed_queue.close();
+    });
+
+    // the conversion runs in the calling thread, so the files are registered in order
+    std::vector<std::unique_ptr<cpp_file>> result;
+    result.reserve(paths.size());
+
+    std::exception_ptr exception;
+    pipeline_file      f;
+    while (!exception && parsed_queue.pop(f))
+    {
+        auto& path = paths[result.size()];
+        if (f.exception)
+            exception = f.exception;
+        else if (f.failed)
+            result.push_back(nullptr);
+        else
+        {
+            try
+            {
+                auto error = false;
+                result.push_back(convert_file(idx, path, logger(), *f.tu, f.preprocessed, error));
+                if (error)
+                    set_error();
+            }
+            catch (...)
+            {
+                handle_exception(path, f);
+                if (f.exception)
+                    exception = f.exception;
+                else
+                    result.push_back(nullptr);
+            }
+        }
+    }
+
+    // stop the other stages early if there was an exception
+    preprocessed_queue.close();
+    parsed_queue.close();
+    preprocessor.join();
+    parser.join();
+
+    if (exception)
+        std::rethrow_exception(exception);
+    return result;
+}
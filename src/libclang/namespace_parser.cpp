@@ -65,8 +65,9 @@ std::unique_ptr<cpp_entity> detail::parse_cpp_namespace(const detail::parse_cont
     {
         // steal comment from parent
         DEBUG_ASSERT(parent.kind() == cpp_namespace::kind(), detail::assert_handler{});
-        builder.get().set_comment(type_safe::copy(parent.comment()));
-        parent.set_comment(type_safe::nullopt);
+        detail::cpp_doc_comment_access::set(builder.get(),
+                                            detail::cpp_doc_comment_access::get(parent));
+        detail::cpp_doc_comment_access::set(parent, 0u);
     }
     else
         context.comments.match(builder.get(), cur);
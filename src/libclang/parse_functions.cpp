@@ -88,10 +88,14 @@ void detail::comment_context::match(cpp_entity& e, unsigned line, bool skip_comm
 {
     // find comment
     auto save = cur_;
-    while (cur_ != end_ && cur_->line + 1 < line)
+    while (cur_ != end_ && (cur_->matched || cur_->line + 1 < line))
         ++cur_;
     if (cur_ != end_ && cur_->matches(e, line))
-        e.set_comment(std::move(cur_++->comment));
+    {
+        cur_->matched = true;
+        detail::cpp_doc_comment_access::set(e, std::uint_least32_t(cur_ - begin_ + 1));
+        ++cur_;
+    }
 
     if (!skip_comments)
         cur_ = save;
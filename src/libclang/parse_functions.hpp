@@ -4,7 +4,11 @@
 #ifndef CPPAST_PARSE_FUNCTIONS_HPP_INCLUDED
 #define CPPAST_PARSE_FUNCTIONS_HPP_INCLUDED
 
+#include <memory>
+#include <unordered_map>
+
 #include <cppast/cpp_entity.hpp>
+#include <cppast/cpp_type.hpp>
 #include <cppast/parser.hpp>
 
 #include "cxtokenizer.hpp" // for convenience
@@ -34,19 +38,63 @@ namespace detail
     {
     public:
         explicit comment_context(std::vector<pp_doc_comment>& comments)
-        : cur_(comments.data()), end_(comments.data() + comments.size())
+        : begin_(comments.data()), cur_(begin_), end_(comments.data() + comments.size())
         {}
 
         // must be called for entities that want an associated comment
         // must be called *BEFORE* the children are added
+        // only the index of the comment is stored in the entity
         void match(cpp_entity& e, const CXCursor& cur) const;
         void match(cpp_entity& e, unsigned line, bool skip_comments = true) const;
 
     private:
+        pp_doc_comment*         begin_;
         mutable pp_doc_comment* cur_;
         pp_doc_comment*         end_;
     };
 
+    // memoizes the parsed types of a translation unit
+    // only types whose result doesn't depend on the cursor they're used at are cached,
+    // i.e. builtin and user-defined types
+    class type_cache
+    {
+    public:
+        type_cache() = default;
+
+        // returns a copy of the type parsed for the CXType, or nullptr if it isn't cached
+        // remove_scope is the result of the scope removal for typedefs,
+        // which depends on the cursor
+        std::unique_ptr<cpp_type> lookup(const CXType& type, bool remove_scope) const;
+
+        // stores a copy of the result, if the CXType can be cached
+        void insert(const CXType& type, bool remove_scope, const cpp_type& result);
+
+    private:
+        struct key
+        {
+            CXTypeKind  kind;
+            const void* data[2];
+            bool        remove_scope;
+
+            key(const CXType& type, bool remove_scope_)
+            : kind(type.kind), data{type.data[0], type.data[1]}, remove_scope(remove_scope_)
+            {}
+
+            bool operator==(const key& other) const noexcept
+            {
+                return kind == other.kind && data[0] == other.data[0]
+                       && data[1] == other.data[1] && remove_scope == other.remove_scope;
+            }
+        };
+
+        struct key_hash
+        {
+            std::size_t operator()(const key& k) const noexcept;
+        };
+
+        std::unordered_map<key, std::unique_ptr<cpp_type>, key_hash> types_;
+    };
+
     struct parse_context
     {
         CXTranslationUnit                              tu;
@@ -55,6 +103,7 @@ namespace detail
         type_safe::object_ref<const cpp_entity_index>  idx;
         comment_context                                comments;
         mutable bool                                   error;
+        mutable type_cache                             types;
     };
 
     // parse default value of variable, function parameter...
@@ -648,11 +648,13 @@ void bump_spaces(position& p, bool bump = false)
             p.skip();
 }
 
-detail::pp_doc_comment parse_c_doc_comment(position& p)
+detail::pp_doc_comment parse_c_doc_comment(position& p, std::string& buffer)
 {
     detail::pp_doc_comment result;
-    result.kind = detail::pp_doc_comment::c;
+    result.kind    = detail::pp_doc_comment::c;
+    result.matched = false;
 
+    auto begin  = buffer.size();
     auto indent = p.cur_column() + 3;
 
     if (starts_with(p, " "))
@@ -667,14 +669,14 @@ detail::pp_doc_comment parse_c_doc_comment(position& p)
         if (starts_with(p, "\n"))
         {
             // remove trailing spaces
-            while (!result.comment.empty() && result.comment.back() == ' ')
-                result.comment.pop_back();
+            while (buffer.size() > begin && buffer.back() == ' ')
+                buffer.pop_back();
 
             // skip newline(s)
             while (starts_with(p, "\n"))
             {
                 p.skip_with_linecount();
-                result.comment += '\n';
+                buffer += '\n';
             }
 
             // skip indentation
@@ -703,27 +705,29 @@ detail::pp_doc_comment parse_c_doc_comment(position& p)
             else
             {
                 // insert extra indent again
-                result.comment += std::string(extra_indent, ' ');
+                buffer.append(extra_indent, ' ');
                 // use minimum indent in the future
                 indent = std::min(actual_indent, indent);
             }
         }
         else
         {
-            result.comment += *p.ptr();
+            buffer += *p.ptr();
             p.skip();
         }
     }
     p.skip(2u);
 
     // remove trailing star
-    if (!result.comment.empty() && result.comment.back() == '*')
-        result.comment.pop_back();
+    if (buffer.size() > begin && buffer.back() == '*')
+        buffer.pop_back();
     // remove trailing spaces
-    while (!result.comment.empty() && result.comment.back() == ' ')
-        result.comment.pop_back();
+    while (buffer.size() > begin && buffer.back() == ' ')
+        buffer.pop_back();
 
-    result.line = p.cur_line();
+    result.offset = std::uint_least32_t(begin);
+    result.size   = std::uint_least32_t(buffer.size() - begin);
+    result.line   = p.cur_line();
     return result;
 }
 
@@ -740,7 +744,7 @@ bool skip_c_comment(position& p, detail::preprocessor_output& output)
     {
         // doc comment
         p.skip();
-        output.comments.push_back(parse_c_doc_comment(p));
+        output.comments.push_back(parse_c_doc_comment(p, output.comment_buffer));
     }
     else
     {
@@ -752,31 +756,36 @@ bool skip_c_comment(position& p, detail::preprocessor_output& output)
     return true;
 }
 
-detail::pp_doc_comment parse_cpp_doc_comment(position& p, bool end_of_line)
+detail::pp_doc_comment parse_cpp_doc_comment(position& p, std::string& buffer, bool end_of_line)
 {
     detail::pp_doc_comment result;
     result.kind = end_of_line ? detail::pp_doc_comment::end_of_line : detail::pp_doc_comment::cpp;
+    result.matched = false;
     if (starts_with(p, " "))
         // skip one whitespace at most
         p.skip();
 
+    auto begin = buffer.size();
     while (!starts_with(p, "\n"))
     {
-        result.comment += *p.ptr();
+        buffer += *p.ptr();
         p.skip();
     }
     // don't skip newline
 
     // remove trailing spaces
-    while (!result.comment.empty() && result.comment.back() == ' ')
-        result.comment.pop_back();
-    result.line = p.cur_line();
+    while (buffer.size() > begin && buffer.back() == ' ')
+        buffer.pop_back();
+
+    result.offset = std::uint_least32_t(begin);
+    result.size   = std::uint_least32_t(buffer.size() - begin);
+    result.line   = p.cur_line();
     return result;
 }
 
 bool can_merge_comment(const detail::pp_doc_comment& comment, unsigned cur_line)
 {
-    return comment.line + 1 == cur_line
+    return comment.line + 1 == cur_line && !comment.matched
            && (comment.kind == detail::pp_doc_comment::cpp
                || comment.kind == detail::pp_doc_comment::end_of_line);
 }
@@ -787,8 +796,11 @@ void merge_or_add(detail::preprocessor_output& output, detail::pp_doc_comment co
         output.comments.push_back(std::move(comment));
     else
     {
+        // the text of the new comment directly follows the text of the previous one
         auto& result = output.comments.back();
-        result.comment += "\n" + std::move(comment.comment);
+        DEBUG_ASSERT(result.offset + result.size == comment.offset, detail::assert_handler{});
+        output.comment_buffer.insert(comment.offset, 1u, '\n');
+        result.size += 1u + comment.size;
         if (result.kind != detail::pp_doc_comment::end_of_line)
             result.line = comment.line;
     }
@@ -804,14 +816,14 @@ bool skip_cpp_comment(position& p, detail::preprocessor_output& output)
     {
         // C++ style doc comment
         p.skip();
-        auto comment = parse_cpp_doc_comment(p, false);
+        auto comment = parse_cpp_doc_comment(p, output.comment_buffer, false);
         merge_or_add(output, std::move(comment));
     }
     else if (p.write_enabled() && starts_with(p, "<"))
     {
         // end of line doc comment
         p.skip();
-        auto comment = parse_cpp_doc_comment(p, true);
+        auto comment = parse_cpp_doc_comment(p, output.comment_buffer, true);
         output.comments.push_back(std::move(comment));
     }
     else
@@ -897,10 +909,11 @@ std::unique_ptr<cpp_macro_definition> parse_macro(position& p, detail::preproces
 
     auto result = build(std::move(name), std::move(args), std::move(rep));
     // match comment directly
-    if (!output.comments.empty() && output.comments.back().matches(*result, cur_line))
+    if (!output.comments.empty() && !output.comments.back().matched
+        && output.comments.back().matches(*result, cur_line))
     {
-        result->set_comment(std::move(output.comments.back().comment));
-        output.comments.pop_back();
+        output.comments.back().matched = true;
+        detail::cpp_doc_comment_access::set(*result, std::uint_least32_t(output.comments.size()));
     }
     return result;
 }
@@ -24,16 +24,18 @@ namespace detail
         unsigned         line;
     };
 
+    // the text is stored in preprocessor_output::comment_buffer
     struct pp_doc_comment
     {
-        std::string comment;
-        unsigned    line;
+        std::uint_least32_t offset, size;
+        unsigned            line;
         enum
         {
             c,
             cpp,
             end_of_line,
         } kind;
+        bool matched;
 
         bool matches(const cpp_entity& e, unsigned line);
     };
@@ -44,6 +46,7 @@ namespace detail
         std::vector<pp_include>     includes;
         std::vector<pp_macro>       macros;
         std::vector<pp_doc_comment> comments;
+        std::string                 comment_buffer;
     };
 
     preprocessor_output preprocess(const libclang_compile_config& config, const char* path,
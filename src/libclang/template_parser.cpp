@@ -199,9 +199,9 @@ void parse_parameters(Builder& builder, const detail::parse_context& context, co
 void handle_comment_attributes(cpp_entity& templ_entity, cpp_entity& non_template)
 {
     // steal comment
-    auto comment = type_safe::copy(non_template.comment());
-    non_template.set_comment(type_safe::nullopt);
-    templ_entity.set_comment(std::move(comment));
+    auto comment = detail::cpp_doc_comment_access::get(non_template);
+    detail::cpp_doc_comment_access::set(non_template, 0u);
+    detail::cpp_doc_comment_access::set(templ_entity, comment);
 
     // copy attributes over
     templ_entity.add_attribute(non_template.attributes());
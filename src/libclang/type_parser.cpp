@@ -554,8 +554,8 @@ std::unique_ptr<cpp_type> try_parse_decltype_type(const detail::parse_context&,
     });
 }
 
-std::unique_ptr<cpp_type> parse_type_impl(const detail::parse_context& context, const CXCursor& cur,
-                                          const CXType& type)
+std::unique_ptr<cpp_type> parse_type_uncached(const detail::parse_context& context,
+                                              const CXCursor& cur, const CXType& type)
 {
     switch (type.kind)
     {
@@ -710,8 +710,129 @@ std::unique_ptr<cpp_type> parse_type_impl(const detail::parse_context& context,
         return make_leave_type(cur, type, [&](std::string&&) { return cpp_auto_type::build(); });
     }
 }
+
+// whether or not the result of parsing the type can only depend on the type itself
+bool is_cacheable(const CXType& type) noexcept
+{
+    switch (type.kind)
+    {
+    case CXType_Void:
+    case CXType_Bool:
+    case CXType_UChar:
+    case CXType_UShort:
+    case CXType_UInt:
+    case CXType_ULong:
+    case CXType_ULongLong:
+    case CXType_UInt128:
+    case CXType_SChar:
+    case CXType_Short:
+    case CXType_Int:
+    case CXType_Long:
+    case CXType_LongLong:
+    case CXType_Int128:
+    case CXType_Float:
+    case CXType_Double:
+    case CXType_LongDouble:
+    case CXType_Float128:
+    case CXType_Char_U:
+    case CXType_Char_S:
+    case CXType_Char16:
+    case CXType_Char32:
+    case CXType_WChar:
+    case CXType_NullPtr:
+    case CXType_Auto:
+    // the scope removal of typedefs is part of the key
+    case CXType_Record:
+    case CXType_Enum:
+    case CXType_Typedef:
+    // only if it isn't an instantiation, see type_cache::insert()
+    case CXType_Elaborated:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// copies a type that can be stored in the cache, returns nullptr for all others
+std::unique_ptr<cpp_type> copy_cacheable_type(const cpp_type& type)
+{
+    switch (type.kind())
+    {
+    case cpp_type_kind::builtin_t:
+        return cpp_builtin_type::build(
+            static_cast<const cpp_builtin_type&>(type).builtin_type_kind());
+    case cpp_type_kind::user_defined_t:
+        return cpp_user_defined_type::build(
+            static_cast<const cpp_user_defined_type&>(type).entity());
+    case cpp_type_kind::auto_t:
+        return cpp_auto_type::build();
+
+    case cpp_type_kind::cv_qualified_t: {
+        auto& cv_type = static_cast<const cpp_cv_qualified_type&>(type);
+        auto  copy    = copy_cacheable_type(cv_type.type());
+        if (!copy)
+            return nullptr;
+        return cpp_cv_qualified_type::build(std::move(copy), cv_type.cv_qualifier());
+    }
+
+    default:
+        return nullptr;
+    }
+}
+
+std::unique_ptr<cpp_type> parse_type_impl(const detail::parse_context& context, const CXCursor& cur,
+                                          const CXType& type)
+{
+    if (!is_cacheable(type))
+        return parse_type_uncached(context, cur, type);
+
+    auto remove_scope = need_to_remove_scope(cur, type);
+    if (auto cached = context.types.lookup(type, remove_scope))
+        return cached;
+
+    auto result = parse_type_uncached(context, cur, type);
+    if (result)
+        context.types.insert(type, remove_scope, *result);
+    return result;
+}
 } // namespace
 
+std::unique_ptr<cpp_type> detail::type_cache::lookup(const CXType& type, bool remove_scope) const
+{
+    auto iter = types_.find(key(type, remove_scope));
+    if (iter == types_.end())
+        return nullptr;
+    return copy_cacheable_type(*iter->second);
+}
+
+void detail::type_cache::insert(const CXType& type, bool remove_scope, const cpp_type& result)
+{
+    if (type.kind == CXType_Elaborated)
+    {
+        // an elaborated type that failed to parse as instantiation might be one
+        // when used at a different cursor, i.e. of a template template parameter
+        auto& leaf = result.kind() == cpp_type_kind::cv_qualified_t
+                         ? static_cast<const cpp_cv_qualified_type&>(result).type()
+                         : result;
+        if (leaf.kind() != cpp_type_kind::user_defined_t
+            || static_cast<const cpp_user_defined_type&>(leaf).entity().name().find('<')
+                   != std::string::npos)
+            return;
+    }
+
+    if (auto copy = copy_cacheable_type(result))
+        types_.emplace(key(type, remove_scope), std::move(copy));
+}
+
+std::size_t detail::type_cache::key_hash::operator()(const key& k) const noexcept
+{
+    auto hash = std::hash<const void*>{}(k.data[0]);
+    hash ^= std::hash<const void*>{}(k.data[1]) + 0x9e3779b9u + (hash << 6) + (hash >> 2);
+    hash ^= std::size_t(k.kind) + 0x9e3779b9u + (hash << 6) + (hash >> 2);
+    return k.remove_scope ? ~hash : hash;
+}
+
 std::unique_ptr<cpp_type> detail::parse_type(const detail::parse_context& context,
                                              const CXCursor& cur, const CXType& type)
 {
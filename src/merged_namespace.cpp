@@ -0,0 +1,67 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/merged_namespace.hpp>
+
+#include <algorithm>
+#include <memory>
+
+using namespace cppast;
+
+merged_namespace::merged_namespace(const cpp_entity_index& idx, const cpp_entity_id& id)
+: merged_namespace([&] {
+      auto namespaces = idx.lookup_namespace(id);
+      return std::vector<type_safe::object_ref<const cpp_namespace>>(namespaces.begin(),
+                                                                     namespaces.end());
+  }())
+{}
+
+merged_namespace::merged_namespace(
+    std::vector<type_safe::object_ref<const cpp_namespace>> namespaces)
+: namespaces_(std::move(namespaces)), member_table_(nullptr)
+{
+    // unregistered namespaces have the biggest index, so they come last
+    std::stable_sort(namespaces_.begin(), namespaces_.end(),
+                     [](type_safe::object_ref<const cpp_namespace> a,
+                        type_safe::object_ref<const cpp_namespace> b) {
+                         return a->dense_index() < b->dense_index();
+                     });
+}
+
+merged_namespace::~merged_namespace() noexcept
+{
+    delete member_table_.load(std::memory_order_relaxed);
+}
+
+const std::string& merged_namespace::name() const noexcept
+{
+    static const std::string empty;
+    return namespaces_.empty() ? empty : namespaces_.front()->name();
+}
+
+type_safe::array_ref<const type_safe::object_ref<const cpp_entity>> merged_namespace::find_members(
+    const std::string& name) const
+{
+    auto& table = get_member_table();
+    auto  iter  = table.find(name);
+    if (iter == table.end())
+        return nullptr;
+    return type_safe::ref(iter->second.data(), iter->second.size());
+}
+
+auto merged_namespace::get_member_table() const -> const member_table&
+{
+    if (auto table = member_table_.load(std::memory_order_acquire))
+        return *table;
+
+    std::unique_ptr<member_table> table(new member_table());
+    for (auto& child : *this)
+        (*table)[child.name()].push_back(type_safe::ref(child));
+
+    // if another thread was faster, use its table instead
+    member_table* expected = nullptr;
+    if (!member_table_.compare_exchange_strong(expected, table.get(), std::memory_order_acq_rel,
+                                               std::memory_order_acquire))
+        return *expected;
+    return *table.release();
+}
@@ -0,0 +1,333 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/ndjson_exporter.hpp>
+
+#include <cstring>
+#include <ostream>
+
+#include <cppast/cpp_class.hpp>
+#include <cppast/cpp_entity_kind.hpp>
+#include <cppast/cpp_enum.hpp>
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_forward_declarable.hpp>
+#include <cppast/cpp_friend.hpp>
+#include <cppast/cpp_function.hpp>
+#include <cppast/cpp_member_function.hpp>
+#include <cppast/cpp_member_variable.hpp>
+#include <cppast/cpp_namespace.hpp>
+#include <cppast/cpp_preprocessor.hpp>
+#include <cppast/cpp_template.hpp>
+#include <cppast/cpp_template_parameter.hpp>
+#include <cppast/cpp_type_alias.hpp>
+#include <cppast/cpp_type_printer.hpp>
+#include <cppast/cpp_variable.hpp>
+#include <cppast/detail/assert.hpp>
+#include <cppast/visitor.hpp>
+
+using namespace cppast;
+
+namespace
+{
+void write_escaped(std::string& buffer, const char* str, std::size_t length)
+{
+    static const char hex[] = "0123456789abcdef";
+    for (auto end = str + length; str != end; ++str)
+    {
+        auto c = static_cast<unsigned char>(*str);
+        if (c == '"' || c == '\\')
+        {
+            buffer += '\\';
+            buffer += char(c);
+        }
+        else if (c == '\n')
+            buffer += "\\n";
+        else if (c == '\t')
+            buffer += "\\t";
+        else if (c < 0x20)
+        {
+            buffer += "\\u00";
+            buffer += hex[c >> 4];
+            buffer += hex[c & 0xf];
+        }
+        else
+            buffer += char(c);
+    }
+}
+
+void write_string(std::string& buffer, const char* str, std::size_t length)
+{
+    buffer += '"';
+    write_escaped(buffer, str, length);
+    buffer += '"';
+}
+
+void write_string(std::string& buffer, const std::string& str)
+{
+    write_string(buffer, str.c_str(), str.size());
+}
+
+void write_uint(std::string& buffer, std::uint_least64_t value)
+{
+    char  digits[20];
+    auto* ptr = digits + sizeof(digits);
+    do
+    {
+        *--ptr = char('0' + value % 10u);
+        value /= 10u;
+    } while (value != 0u);
+    buffer.append(ptr, std::size_t(digits + sizeof(digits) - ptr));
+}
+
+void write_id(std::string& buffer, const cpp_entity_id& id)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    auto value = static_cast<detail::hash_type>(id);
+    char digits[16];
+    for (auto i = 0u; i != 16u; ++i)
+    {
+        digits[15u - i] = hex[value & 0xf];
+        value >>= 4u;
+    }
+
+    buffer += '"';
+    buffer.append(digits, sizeof(digits));
+    buffer += '"';
+}
+
+// collects the references as JSON array elements
+class reference_writer
+{
+public:
+    explicit reference_writer(std::string& refs) : refs_(&refs) {}
+
+    void write(type_safe::array_ref<const cpp_entity_id> ids, string_view name)
+    {
+        if (!refs_->empty())
+            *refs_ += ',';
+        *refs_ += "{\"name\":";
+        write_string(*refs_, name.c_str(), name.length());
+        *refs_ += ",\"target\":[";
+        auto first = true;
+        for (auto& id : ids)
+        {
+            if (!first)
+                *refs_ += ',';
+            first = false;
+            write_id(*refs_, id);
+        }
+        *refs_ += "]}";
+    }
+
+    template <typename T, typename Predicate>
+    void write(const basic_cpp_entity_ref<T, Predicate>& ref)
+    {
+        write(ref.id(), ref.name());
+    }
+
+private:
+    std::string* refs_;
+};
+
+// writes the escaped spelling of a type into the buffer and collects the references
+void write_type(std::string& buffer, std::string& spelling, reference_writer& refs,
+                const cpp_type& type)
+{
+    cpp_type_printer printer;
+    printer.set_reference_callback(
+        [](void* user_data, type_safe::array_ref<const cpp_entity_id> ids, string_view name) {
+            static_cast<reference_writer*>(user_data)->write(ids, name);
+        },
+        &refs);
+
+    spelling.clear();
+    printer.write(spelling, type);
+    write_string(buffer, spelling);
+}
+
+type_safe::optional_ref<const cpp_type> get_type(const cpp_entity& e)
+{
+    switch (e.kind())
+    {
+    case cpp_entity_kind::variable_t:
+        return type_safe::ref(static_cast<const cpp_variable&>(e).type());
+    case cpp_entity_kind::member_variable_t:
+    case cpp_entity_kind::bitfield_t:
+        return type_safe::ref(static_cast<const cpp_member_variable_base&>(e).type());
+    case cpp_entity_kind::function_parameter_t:
+        return type_safe::ref(static_cast<const cpp_function_parameter&>(e).type());
+    case cpp_entity_kind::non_type_template_parameter_t:
+        return type_safe::ref(static_cast<const cpp_non_type_template_parameter&>(e).type());
+
+    case cpp_entity_kind::function_t:
+        return type_safe::ref(static_cast<const cpp_function&>(e).return_type());
+    case cpp_entity_kind::member_function_t:
+    case cpp_entity_kind::conversion_op_t:
+        return type_safe::ref(static_cast<const cpp_member_function_base&>(e).return_type());
+
+    case cpp_entity_kind::type_alias_t:
+        return type_safe::ref(static_cast<const cpp_type_alias&>(e).underlying_type());
+    case cpp_entity_kind::base_class_t:
+        return type_safe::ref(static_cast<const cpp_base_class&>(e).type());
+    case cpp_entity_kind::enum_t:
+    {
+        auto& enum_ = static_cast<const cpp_enum&>(e);
+        if (enum_.has_explicit_type())
+            return type_safe::ref(enum_.underlying_type());
+        break;
+    }
+    case cpp_entity_kind::friend_t:
+        return static_cast<const cpp_friend&>(e).type();
+
+    case cpp_entity_kind::alias_template_t:
+    case cpp_entity_kind::variable_template_t:
+    case cpp_entity_kind::function_template_t:
+    case cpp_entity_kind::function_template_specialization_t:
+        // the templated entity isn't written, so its type belongs to the template
+        return get_type(*static_cast<const cpp_template&>(e).begin());
+
+    default:
+        break;
+    }
+
+    return type_safe::nullopt;
+}
+
+void write_target(reference_writer& refs, const cpp_entity& e)
+{
+    switch (e.kind())
+    {
+    case cpp_entity_kind::namespace_alias_t:
+        refs.write(static_cast<const cpp_namespace_alias&>(e).target());
+        break;
+    case cpp_entity_kind::using_directive_t:
+        refs.write(static_cast<const cpp_using_directive&>(e).target());
+        break;
+    case cpp_entity_kind::using_declaration_t:
+        refs.write(static_cast<const cpp_using_declaration&>(e).target());
+        break;
+    case cpp_entity_kind::include_directive_t:
+        refs.write(static_cast<const cpp_include_directive&>(e).target());
+        break;
+
+    default:
+        break;
+    }
+}
+} // namespace
+
+ndjson_exporter::ndjson_exporter(std::ostream& out, std::size_t buffer_size)
+: out_(&out), buffer_size_(buffer_size), next_id_(1u)
+{
+    buffer_.reserve(buffer_size_);
+}
+
+ndjson_exporter::~ndjson_exporter() noexcept
+{
+    flush();
+}
+
+void ndjson_exporter::write(const cpp_file& file)
+{
+    visit(file, [&](const cpp_entity& e, visitor_info info) {
+        if (info.event == visitor_info::container_entity_exit)
+        {
+            parents_.pop_back();
+            return true;
+        }
+
+        auto parent = parents_.empty() ? 0u : parents_.back();
+        auto id     = parent;
+        if (!is_templated(e) && !is_friended(e))
+        {
+            // templated and friended entities are just proxies,
+            // their children belong to the template or friend
+            id = next_id_++;
+            write_record(e, id, parent,
+                         e.parent() && e.parent().value().kind() == cpp_entity_kind::class_t
+                             ? to_string(info.access)
+                             : nullptr);
+            write_parameters(e, id);
+        }
+
+        if (info.event == visitor_info::container_entity_enter)
+            parents_.push_back(id);
+        return true;
+    });
+    DEBUG_ASSERT(parents_.empty(), detail::assert_handler{});
+}
+
+void ndjson_exporter::flush()
+{
+    out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+void ndjson_exporter::write_parameters(const cpp_entity& e, std::uint_least64_t id)
+{
+    // parameters are not visited
+    if (is_function(e.kind()))
+        for (auto& param : static_cast<const cpp_function_base&>(e).parameters())
+            write_record(param, next_id_++, id, nullptr);
+    else if (e.kind() == cpp_entity_kind::template_template_parameter_t)
+        for (auto& param : static_cast<const cpp_template_template_parameter&>(e).parameters())
+        {
+            auto param_id = next_id_++;
+            write_record(param, param_id, id, nullptr);
+            write_parameters(param, param_id);
+        }
+    else if (is_template(e.kind()))
+    {
+        auto& templ = static_cast<const cpp_template&>(e);
+        for (auto& param : templ.parameters())
+        {
+            auto param_id = next_id_++;
+            write_record(param, param_id, id, nullptr);
+            write_parameters(param, param_id);
+        }
+
+        // the templated entity isn't written, so its parameters belong to the template
+        write_parameters(*templ.begin(), id);
+    }
+}
+
+void ndjson_exporter::write_record(const cpp_entity& e, std::uint_least64_t id,
+                                   std::uint_least64_t parent, const char* access)
+{
+    buffer_ += "{\"id\":";
+    write_uint(buffer_, id);
+    buffer_ += ",\"parent\":";
+    write_uint(buffer_, parent);
+    buffer_ += ",\"kind\":";
+    auto kind = to_string(e.kind());
+    write_string(buffer_, kind, std::strlen(kind));
+    buffer_ += ",\"name\":";
+    write_string(buffer_, e.name());
+    if (access)
+    {
+        buffer_ += ",\"access\":";
+        write_string(buffer_, access, std::strlen(access));
+    }
+    buffer_ += is_definition(e) ? ",\"definition\":true" : ",\"definition\":false";
+
+    // the references are only known after the type has been written
+    refs_.clear();
+    reference_writer ref_writer(refs_);
+    if (auto type = get_type(e))
+    {
+        buffer_ += ",\"type\":";
+        write_type(buffer_, type_, ref_writer, type.value());
+    }
+    write_target(ref_writer, e);
+    if (!refs_.empty())
+    {
+        buffer_ += ",\"refs\":[";
+        buffer_ += refs_;
+        buffer_ += ']';
+    }
+
+    buffer_ += "}\n";
+    if (buffer_.size() >= buffer_size_)
+        flush();
+}
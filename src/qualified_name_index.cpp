@@ -0,0 +1,244 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/qualified_name_index.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+#include <cppast/cpp_class.hpp>
+#include <cppast/cpp_entity_kind.hpp>
+#include <cppast/cpp_enum.hpp>
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_language_linkage.hpp>
+#include <cppast/cpp_namespace.hpp>
+#include <cppast/cpp_template.hpp>
+
+using namespace cppast;
+
+namespace
+{
+bool is_indexed(const cpp_entity& e) noexcept
+{
+    if (e.name().empty() || is_templated(e))
+        return false;
+
+    switch (e.kind())
+    {
+    case cpp_entity_kind::file_t:
+    case cpp_entity_kind::access_specifier_t:
+    case cpp_entity_kind::include_directive_t:
+    case cpp_entity_kind::using_directive_t:
+    case cpp_entity_kind::using_declaration_t:
+    case cpp_entity_kind::friend_t:
+    case cpp_entity_kind::static_assert_t:
+    case cpp_entity_kind::unexposed_t:
+        return false;
+
+    default:
+        return true;
+    }
+}
+
+template <class Entry, typename Container>
+void add_children(std::vector<Entry>& result, std::string& scope, const Container& container);
+
+// adds the entity and its children, scope is the qualified name of the parent followed by `::`
+template <class Entry>
+void add_entity(std::vector<Entry>& result, std::string& scope, const cpp_entity& e)
+{
+    if (is_indexed(e))
+        result.emplace_back(scope + e.name(), e);
+
+    // the children of a template are in the scope of the templated entity
+    auto old_size = scope.size();
+    if (!is_template(e.kind()) && e.scope_name() && !e.name().empty())
+    {
+        scope += e.name();
+        scope += "::";
+    }
+
+    switch (e.kind())
+    {
+    case cpp_entity_kind::file_t:
+        add_children(result, scope, static_cast<const cpp_file&>(e));
+        break;
+    case cpp_entity_kind::language_linkage_t:
+        add_children(result, scope, static_cast<const cpp_language_linkage&>(e));
+        break;
+    case cpp_entity_kind::namespace_t:
+        add_children(result, scope, static_cast<const cpp_namespace&>(e));
+        break;
+    case cpp_entity_kind::enum_t:
+        add_children(result, scope, static_cast<const cpp_enum&>(e));
+        break;
+    case cpp_entity_kind::class_t:
+        add_children(result, scope, static_cast<const cpp_class&>(e));
+        break;
+
+    case cpp_entity_kind::alias_template_t:
+    case cpp_entity_kind::variable_template_t:
+    case cpp_entity_kind::function_template_t:
+    case cpp_entity_kind::function_template_specialization_t:
+    case cpp_entity_kind::class_template_t:
+    case cpp_entity_kind::class_template_specialization_t:
+        add_children(result, scope, static_cast<const cpp_template&>(e));
+        break;
+
+    default:
+        break;
+    }
+
+    scope.resize(old_size);
+}
+
+template <class Entry, typename Container>
+void add_children(std::vector<Entry>& result, std::string& scope, const Container& container)
+{
+    for (auto& child : container)
+        add_entity(result, scope, child);
+}
+
+bool starts_with(const std::string& str, const std::string& prefix) noexcept
+{
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool glob_match(const char* str, const char* pattern) noexcept
+{
+    // position after the last `*` and the corresponding string position, for backtracking
+    const char* star_pattern = nullptr;
+    const char* star_str     = nullptr;
+    while (*str)
+    {
+        if (*pattern == '*')
+        {
+            star_pattern = ++pattern;
+            star_str     = str;
+        }
+        else if (*pattern == '?' || *pattern == *str)
+        {
+            ++pattern;
+            ++str;
+        }
+        else if (star_pattern)
+        {
+            // let the `*` match one more character
+            pattern = star_pattern;
+            str     = ++star_str;
+        }
+        else
+            return false;
+    }
+
+    while (*pattern == '*')
+        ++pattern;
+    return *pattern == '\0';
+}
+} // namespace
+
+void qualified_name_index::add(const cpp_file& file)
+{
+    std::vector<entry> entries;
+    std::string        scope;
+    add_entity(entries, scope, file);
+
+    std::lock_guard<detail::shared_mutex> lock(mutex_);
+    pending_.insert(pending_.end(), std::make_move_iterator(entries.begin()),
+                    std::make_move_iterator(entries.end()));
+    dirty_.store(true, std::memory_order_release);
+}
+
+void qualified_name_index::update() const
+{
+    if (!dirty_.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard<detail::shared_mutex> lock(mutex_);
+    if (!dirty_.load(std::memory_order_relaxed))
+        return;
+
+    auto compare = [](const entry& lhs, const entry& rhs) { return lhs.name < rhs.name; };
+    std::stable_sort(pending_.begin(), pending_.end(), compare);
+
+    auto middle = entries_.size();
+    entries_.insert(entries_.end(), std::make_move_iterator(pending_.begin()),
+                    std::make_move_iterator(pending_.end()));
+    std::inplace_merge(entries_.begin(),
+                       entries_.begin() + static_cast<std::ptrdiff_t>(middle), entries_.end(),
+                       compare);
+
+    pending_.clear();
+    dirty_.store(false, std::memory_order_release);
+}
+
+qualified_name_index::iterator qualified_name_index::lower_bound(
+    const std::string& name) const noexcept
+{
+    return std::lower_bound(entries_.cbegin(), entries_.cend(), name,
+                            [](const entry& e, const std::string& value) {
+                                return e.name < value;
+                            });
+}
+
+qualified_name_index::iterator qualified_name_index::prefix_end(
+    iterator begin, const std::string& prefix) const noexcept
+{
+    return std::partition_point(begin, entries_.cend(), [&](const entry& e) {
+        return starts_with(e.name, prefix);
+    });
+}
+
+std::vector<type_safe::object_ref<const cpp_entity>> qualified_name_index::lookup(
+    const std::string& name) const
+{
+    update();
+
+    std::vector<type_safe::object_ref<const cpp_entity>> result;
+
+    detail::shared_lock lock(mutex_);
+    auto                begin = lower_bound(name);
+    for (auto iter = begin; iter != entries_.end() && iter->name == name; ++iter)
+        result.push_back(type_safe::ref(*iter->entity));
+    return result;
+}
+
+std::vector<type_safe::object_ref<const cpp_entity>> qualified_name_index::lookup_prefix(
+    const std::string& prefix) const
+{
+    update();
+
+    std::vector<type_safe::object_ref<const cpp_entity>> result;
+
+    detail::shared_lock lock(mutex_);
+    auto                begin = lower_bound(prefix);
+    auto                end   = prefix_end(begin, prefix);
+    for (auto iter = begin; iter != end; ++iter)
+        result.push_back(type_safe::ref(*iter->entity));
+    return result;
+}
+
+std::vector<type_safe::object_ref<const cpp_entity>> qualified_name_index::lookup_glob(
+    const std::string& pattern) const
+{
+    update();
+
+    std::vector<type_safe::object_ref<const cpp_entity>> result;
+
+    // only the names starting with the literal prefix can match
+    auto prefix = pattern.substr(0, pattern.find_first_of("*?"));
+
+    detail::shared_lock lock(mutex_);
+    auto                begin = lower_bound(prefix);
+    auto                end   = prefix_end(begin, prefix);
+    for (auto iter = begin; iter != end; ++iter)
+        if (glob_match(iter->name.c_str() + prefix.size(), pattern.c_str() + prefix.size()))
+            result.push_back(type_safe::ref(*iter->entity));
+    return result;
+}
+
+std::size_t qualified_name_index::size() const noexcept
+{
+    detail::shared_lock lock(mutex_);
+    return entries_.size() + pending_.size();
+}
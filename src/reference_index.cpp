@@ -0,0 +1,295 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/reference_index.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <cppast/cpp_array_type.hpp>
+#include <cppast/cpp_class.hpp>
+#include <cppast/cpp_entity_kind.hpp>
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_function.hpp>
+#include <cppast/cpp_function_type.hpp>
+#include <cppast/cpp_language_linkage.hpp>
+#include <cppast/cpp_member_function.hpp>
+#include <cppast/cpp_member_variable.hpp>
+#include <cppast/cpp_namespace.hpp>
+#include <cppast/cpp_template.hpp>
+#include <cppast/cpp_type.hpp>
+#include <cppast/cpp_type_alias.hpp>
+#include <cppast/cpp_variable.hpp>
+
+using namespace cppast;
+
+const char* cppast::to_string(cpp_reference_role role) noexcept
+{
+    switch (role)
+    {
+    case cpp_reference_role::base:
+        return "base";
+    case cpp_reference_role::parameter:
+        return "parameter";
+    case cpp_reference_role::return_type:
+        return "return type";
+    case cpp_reference_role::member:
+        return "member";
+    case cpp_reference_role::variable:
+        return "variable";
+    case cpp_reference_role::alias:
+        return "alias";
+    }
+
+    return "should not get here";
+}
+
+namespace
+{
+template <class Map>
+class reference_collector
+{
+public:
+    explicit reference_collector(Map& map) : map_(&map) {}
+
+    void add_entity(const cpp_entity& e)
+    {
+        switch (e.kind())
+        {
+        case cpp_entity_kind::file_t:
+            add_children(static_cast<const cpp_file&>(e));
+            break;
+        case cpp_entity_kind::language_linkage_t:
+            add_children(static_cast<const cpp_language_linkage&>(e));
+            break;
+        case cpp_entity_kind::namespace_t:
+            add_children(static_cast<const cpp_namespace&>(e));
+            break;
+        case cpp_entity_kind::class_t:
+        {
+            auto& c = static_cast<const cpp_class&>(e);
+            for (auto& base : c.bases())
+                add_type(e, cpp_reference_role::base, base.type());
+            add_children(c);
+            break;
+        }
+
+        case cpp_entity_kind::alias_template_t:
+        case cpp_entity_kind::variable_template_t:
+        case cpp_entity_kind::function_template_t:
+        case cpp_entity_kind::function_template_specialization_t:
+        case cpp_entity_kind::class_template_t:
+        case cpp_entity_kind::class_template_specialization_t:
+            add_children(static_cast<const cpp_template&>(e));
+            break;
+
+        case cpp_entity_kind::function_t:
+            add_type(e, cpp_reference_role::return_type,
+                     static_cast<const cpp_function&>(e).return_type());
+            add_parameters(static_cast<const cpp_function_base&>(e));
+            break;
+        case cpp_entity_kind::member_function_t:
+        case cpp_entity_kind::conversion_op_t:
+            add_type(e, cpp_reference_role::return_type,
+                     static_cast<const cpp_member_function_base&>(e).return_type());
+            add_parameters(static_cast<const cpp_function_base&>(e));
+            break;
+        case cpp_entity_kind::constructor_t:
+        case cpp_entity_kind::destructor_t:
+            add_parameters(static_cast<const cpp_function_base&>(e));
+            break;
+
+        case cpp_entity_kind::member_variable_t:
+        case cpp_entity_kind::bitfield_t:
+            add_type(e, cpp_reference_role::member,
+                     static_cast<const cpp_member_variable_base&>(e).type());
+            break;
+        case cpp_entity_kind::variable_t:
+            add_type(e, cpp_reference_role::variable, static_cast<const cpp_variable&>(e).type());
+            break;
+        case cpp_entity_kind::type_alias_t:
+            add_type(e, cpp_reference_role::alias,
+                     static_cast<const cpp_type_alias&>(e).underlying_type());
+            break;
+
+        default:
+            break;
+        }
+    }
+
+private:
+    template <typename Container>
+    void add_children(const Container& container)
+    {
+        for (auto& child : container)
+            add_entity(child);
+    }
+
+    void add_parameters(const cpp_function_base& func)
+    {
+        for (auto& param : func.parameters())
+            add_type(func, cpp_reference_role::parameter, param.type());
+    }
+
+    template <class Ref>
+    void add_ref(const cpp_entity& e, cpp_reference_role role, const Ref& ref)
+    {
+        for (auto& id : ref.id())
+        {
+            auto& references = (*map_)[id];
+            // the same entity refers to the target multiple times, e.g. in multiple parameters
+            if (!references.empty() && &*references.back().entity == &e
+                && references.back().role == role)
+                continue;
+            references.emplace_back(e, role);
+        }
+    }
+
+    void add_type(const cpp_entity& e, cpp_reference_role role, const cpp_type& type)
+    {
+        switch (type.kind())
+        {
+        case cpp_type_kind::user_defined_t:
+            add_ref(e, role, static_cast<const cpp_user_defined_type&>(type).entity());
+            break;
+
+        case cpp_type_kind::cv_qualified_t:
+            add_type(e, role, static_cast<const cpp_cv_qualified_type&>(type).type());
+            break;
+        case cpp_type_kind::pointer_t:
+            add_type(e, role, static_cast<const cpp_pointer_type&>(type).pointee());
+            break;
+        case cpp_type_kind::reference_t:
+            add_type(e, role, static_cast<const cpp_reference_type&>(type).referee());
+            break;
+        case cpp_type_kind::array_t:
+            add_type(e, role, static_cast<const cpp_array_type&>(type).value_type());
+            break;
+
+        case cpp_type_kind::function_t:
+        {
+            auto& func = static_cast<const cpp_function_type&>(type);
+            add_type(e, role, func.return_type());
+            for (auto& param : func.parameter_types())
+                add_type(e, role, param);
+            break;
+        }
+        case cpp_type_kind::member_function_t:
+        {
+            auto& func = static_cast<const cpp_member_function_type&>(type);
+            add_type(e, role, func.class_type());
+            add_type(e, role, func.return_type());
+            for (auto& param : func.parameter_types())
+                add_type(e, role, param);
+            break;
+        }
+        case cpp_type_kind::member_object_t:
+        {
+            auto& obj = static_cast<const cpp_member_object_type&>(type);
+            add_type(e, role, obj.class_type());
+            add_type(e, role, obj.object_type());
+            break;
+        }
+
+        case cpp_type_kind::template_instantiation_t:
+        {
+            auto& inst = static_cast<const cpp_template_instantiation_type&>(type);
+            add_ref(e, role, inst.primary_template());
+            if (auto arguments = inst.arguments())
+                for (auto& arg : arguments.value())
+                    if (auto arg_type = arg.type())
+                        add_type(e, role, arg_type.value());
+            break;
+        }
+
+        case cpp_type_kind::builtin_t:
+        case cpp_type_kind::auto_t:
+        case cpp_type_kind::decltype_t:
+        case cpp_type_kind::decltype_auto_t:
+        case cpp_type_kind::template_parameter_t:
+        case cpp_type_kind::dependent_t:
+        case cpp_type_kind::unexposed_t:
+            break;
+        }
+    }
+
+    Map* map_;
+};
+} // namespace
+
+void reference_index::add(const cpp_file& file)
+{
+    map references;
+    reference_collector<map>(references).add_entity(file);
+    merge(references);
+}
+
+void reference_index::add(const std::vector<const cpp_file*>& files, unsigned thread_count)
+{
+    if (thread_count == 0u)
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    if (thread_count > files.size())
+        thread_count = unsigned(files.size());
+
+    // each file is processed into its own map, so the threads don't need to synchronize
+    std::vector<map>         results(files.size());
+    std::atomic<std::size_t> next(0u);
+    auto                     worker = [&] {
+        for (auto i = next++; i < files.size(); i = next++)
+            reference_collector<map>(results[i]).add_entity(*files[i]);
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 1u; i < thread_count; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& result : results)
+        merge(result);
+}
+
+void reference_index::merge(map& references)
+{
+    std::lock_guard<detail::shared_mutex> lock(mutex_);
+    for (auto& entry : references)
+    {
+        auto& target = references_[entry.first];
+        if (target.empty())
+            target = std::move(entry.second);
+        else
+            target.insert(target.end(), entry.second.begin(), entry.second.end());
+    }
+}
+
+std::vector<reference_index::reference> reference_index::lookup(const cpp_entity_id& target) const
+{
+    detail::shared_lock lock(mutex_);
+    auto                iter = references_.find(target);
+    if (iter == references_.end())
+        return {};
+    return iter->second;
+}
+
+std::vector<type_safe::object_ref<const cpp_entity>> reference_index::lookup(
+    const cpp_entity_id& target, cpp_reference_role role) const
+{
+    std::vector<type_safe::object_ref<const cpp_entity>> result;
+
+    detail::shared_lock lock(mutex_);
+    auto                iter = references_.find(target);
+    if (iter != references_.end())
+        for (auto& ref : iter->second)
+            if (ref.role == role)
+                result.push_back(ref.entity);
+    return result;
+}
+
+std::size_t reference_index::size() const noexcept
+{
+    detail::shared_lock lock(mutex_);
+    return references_.size();
+}
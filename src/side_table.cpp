@@ -0,0 +1,88 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/side_table.hpp>
+
+#include <algorithm>
+
+using namespace cppast;
+
+namespace
+{
+unsigned popcount(std::uint_least64_t word) noexcept
+{
+#if defined(__GNUC__)
+    return unsigned(__builtin_popcountll(word));
+#else
+    auto result = 0u;
+    for (; word != 0u; word &= word - 1u)
+        ++result;
+    return result;
+#endif
+}
+} // namespace
+
+std::size_t entity_bitset::count() const noexcept
+{
+    auto result = std::size_t(0);
+    for (auto word : words_)
+        result += popcount(word);
+    return result;
+}
+
+bool entity_bitset::empty() const noexcept
+{
+    return std::all_of(words_.begin(), words_.end(), [](word_type word) { return word == 0u; });
+}
+
+entity_bitset& entity_bitset::operator|=(const entity_bitset& other)
+{
+    if (words_.size() < other.words_.size())
+        words_.resize(other.words_.size(), 0u);
+    for (auto i = std::size_t(0); i != other.words_.size(); ++i)
+        words_[i] |= other.words_[i];
+    return *this;
+}
+
+entity_bitset& entity_bitset::operator&=(const entity_bitset& other) noexcept
+{
+    // entities beyond the size of other aren't in the intersection
+    if (words_.size() > other.words_.size())
+        words_.resize(other.words_.size());
+    for (auto i = std::size_t(0); i != words_.size(); ++i)
+        words_[i] &= other.words_[i];
+    return *this;
+}
+
+entity_bitset& entity_bitset::operator-=(const entity_bitset& other) noexcept
+{
+    auto size = std::min(words_.size(), other.words_.size());
+    for (auto i = std::size_t(0); i != size; ++i)
+        words_[i] &= ~other.words_[i];
+    return *this;
+}
+
+namespace cppast
+{
+bool operator==(const entity_bitset& lhs, const entity_bitset& rhs) noexcept
+{
+    // the sets can have different sizes but the same entities
+    auto& shorter = lhs.words_.size() < rhs.words_.size() ? lhs.words_ : rhs.words_;
+    auto& longer  = lhs.words_.size() < rhs.words_.size() ? rhs.words_ : lhs.words_;
+    return std::equal(shorter.begin(), shorter.end(), longer.begin())
+           && std::all_of(longer.begin() + std::ptrdiff_t(shorter.size()), longer.end(),
+                          [](std::uint_least64_t word) { return word == 0u; });
+}
+} // namespace cppast
+
+unsigned entity_bitset::lowest_bit(word_type word) noexcept
+{
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll(word));
+#else
+    auto result = 0u;
+    for (; (word & 1u) == 0u; word >>= 1u)
+        ++result;
+    return result;
+#endif
+}
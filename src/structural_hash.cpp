@@ -0,0 +1,567 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/structural_hash.hpp>
+
+#include <cppast/cpp_alias_template.hpp>
+#include <cppast/cpp_array_type.hpp>
+#include <cppast/cpp_class.hpp>
+#include <cppast/cpp_class_template.hpp>
+#include <cppast/cpp_decltype_type.hpp>
+#include <cppast/cpp_entity_kind.hpp>
+#include <cppast/cpp_enum.hpp>
+#include <cppast/cpp_expression.hpp>
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_friend.hpp>
+#include <cppast/cpp_function.hpp>
+#include <cppast/cpp_function_template.hpp>
+#include <cppast/cpp_function_type.hpp>
+#include <cppast/cpp_language_linkage.hpp>
+#include <cppast/cpp_member_function.hpp>
+#include <cppast/cpp_member_variable.hpp>
+#include <cppast/cpp_namespace.hpp>
+#include <cppast/cpp_preprocessor.hpp>
+#include <cppast/cpp_static_assert.hpp>
+#include <cppast/cpp_template.hpp>
+#include <cppast/cpp_template_parameter.hpp>
+#include <cppast/cpp_type_alias.hpp>
+#include <cppast/cpp_variable.hpp>
+#include <cppast/cpp_variable_template.hpp>
+#include <cppast/detail/assert.hpp>
+
+using namespace cppast;
+
+namespace cppast
+{
+namespace detail
+{
+    struct cpp_structural_hash_access
+    {
+        static std::atomic<std::uint_least64_t>& get(const cpp_entity& e) noexcept
+        {
+            return e.structural_hash_;
+        }
+
+        static std::atomic<std::uint_least64_t>& get(const cpp_type& type) noexcept
+        {
+            return type.structural_hash_;
+        }
+    };
+} // namespace detail
+} // namespace cppast
+
+namespace
+{
+// FNV-1a over the bytes of the combined values, finalized by a bit mixer
+class hasher
+{
+public:
+    hasher() noexcept : hash_(14695981039346656037ull) {}
+
+    hasher& add(std::uint_least64_t value) noexcept
+    {
+        for (auto i = 0u; i != 8u; ++i)
+        {
+            hash_ = (hash_ ^ (value & 0xffu)) * 1099511628211ull;
+            value >>= 8u;
+        }
+        return *this;
+    }
+
+    hasher& add(bool value) noexcept
+    {
+        return add(std::uint_least64_t(value ? 1u : 0u));
+    }
+
+    hasher& add(const char* str, std::size_t length) noexcept
+    {
+        for (auto end = str + length; str != end; ++str)
+            hash_ = (hash_ ^ static_cast<unsigned char>(*str)) * 1099511628211ull;
+        // so that "ab" "c" and "a" "bc" differ
+        return add(std::uint_least64_t(length));
+    }
+
+    hasher& add(const std::string& str) noexcept
+    {
+        return add(str.c_str(), str.size());
+    }
+
+    hasher& add(const cpp_token_string& tokens)
+    {
+        add(std::uint_least64_t(0x746f6b656e73ull));
+        for (auto& token : tokens)
+            add(token.spelling);
+        return *this;
+    }
+
+    template <typename T, typename Predicate>
+    hasher& add(const basic_cpp_entity_ref<T, Predicate>& ref) noexcept
+    {
+        add(ref.name());
+        for (auto& id : ref.id())
+            add(std::uint_least64_t(static_cast<detail::hash_type>(id)));
+        return *this;
+    }
+
+    hasher& add(const cpp_type& type)
+    {
+        return add(structural_hash(type));
+    }
+
+    hasher& add(const cpp_entity& e)
+    {
+        return add(structural_hash(e));
+    }
+
+    hasher& add(const cpp_expression& expr);
+
+    template <typename T>
+    hasher& add(const type_safe::optional_ref<T>& opt)
+    {
+        add(opt.has_value());
+        if (opt)
+            add(opt.value());
+        return *this;
+    }
+
+    template <typename T>
+    hasher& add_children(const T& container)
+    {
+        auto count = std::uint_least64_t(0);
+        for (auto& child : container)
+        {
+            add(child);
+            ++count;
+        }
+        return add(count);
+    }
+
+    std::uint_least64_t finish() const noexcept
+    {
+        // murmur3 finalizer
+        auto result = hash_;
+        result ^= result >> 33u;
+        result *= 0xff51afd7ed558ccdull;
+        result ^= result >> 33u;
+        result *= 0xc4ceb9fe1a85ec53ull;
+        result ^= result >> 33u;
+        // 0 marks a hash that isn't computed yet
+        return result == 0u ? 1u : result;
+    }
+
+private:
+    std::uint_least64_t hash_;
+};
+
+hasher& hasher::add(const cpp_expression& expr)
+{
+    add(std::uint_least64_t(expr.kind())).add(expr.type());
+    switch (expr.kind())
+    {
+    case cpp_expression_kind::literal_t:
+        add(static_cast<const cpp_literal_expression&>(expr).value());
+        break;
+    case cpp_expression_kind::unexposed_t:
+        add(static_cast<const cpp_unexposed_expression&>(expr).expression());
+        break;
+    }
+    return *this;
+}
+
+void add_template_argument(hasher& h, const cpp_template_argument& arg)
+{
+    if (auto type = arg.type())
+        h.add(std::uint_least64_t(0u)).add(type.value());
+    else if (auto expr = arg.expression())
+        h.add(std::uint_least64_t(1u)).add(expr.value());
+    else if (auto templ = arg.template_ref())
+        h.add(std::uint_least64_t(2u)).add(templ.value());
+}
+
+void add_function_type(hasher& h, const cpp_type& return_type,
+                       detail::iteratable_intrusive_list<cpp_type> parameters, bool variadic)
+{
+    h.add(return_type).add_children(parameters).add(variadic);
+}
+
+std::uint_least64_t compute_hash(const cpp_type& type)
+{
+    hasher h;
+    h.add(std::uint_least64_t(type.kind()));
+    switch (type.kind())
+    {
+    case cpp_type_kind::builtin_t:
+        h.add(std::uint_least64_t(static_cast<const cpp_builtin_type&>(type).builtin_type_kind()));
+        break;
+    case cpp_type_kind::user_defined_t:
+        h.add(static_cast<const cpp_user_defined_type&>(type).entity());
+        break;
+
+    case cpp_type_kind::auto_t:
+    case cpp_type_kind::decltype_auto_t:
+        break;
+    case cpp_type_kind::decltype_t:
+        h.add(static_cast<const cpp_decltype_type&>(type).expression());
+        break;
+
+    case cpp_type_kind::cv_qualified_t:
+    {
+        auto& cv = static_cast<const cpp_cv_qualified_type&>(type);
+        h.add(std::uint_least64_t(cv.cv_qualifier())).add(cv.type());
+        break;
+    }
+    case cpp_type_kind::pointer_t:
+        h.add(static_cast<const cpp_pointer_type&>(type).pointee());
+        break;
+    case cpp_type_kind::reference_t:
+    {
+        auto& ref = static_cast<const cpp_reference_type&>(type);
+        h.add(std::uint_least64_t(ref.reference_kind())).add(ref.referee());
+        break;
+    }
+
+    case cpp_type_kind::array_t:
+    {
+        auto& array = static_cast<const cpp_array_type&>(type);
+        h.add(array.value_type()).add(array.size());
+        break;
+    }
+    case cpp_type_kind::function_t:
+    {
+        auto& func = static_cast<const cpp_function_type&>(type);
+        add_function_type(h, func.return_type(), func.parameter_types(), func.is_variadic());
+        break;
+    }
+    case cpp_type_kind::member_function_t:
+    {
+        auto& func = static_cast<const cpp_member_function_type&>(type);
+        h.add(func.class_type());
+        add_function_type(h, func.return_type(), func.parameter_types(), func.is_variadic());
+        break;
+    }
+    case cpp_type_kind::member_object_t:
+    {
+        auto& obj = static_cast<const cpp_member_object_type&>(type);
+        h.add(obj.class_type()).add(obj.object_type());
+        break;
+    }
+
+    case cpp_type_kind::template_parameter_t:
+        h.add(static_cast<const cpp_template_parameter_type&>(type).entity());
+        break;
+    case cpp_type_kind::template_instantiation_t:
+    {
+        auto& inst = static_cast<const cpp_template_instantiation_type&>(type);
+        h.add(inst.primary_template()).add(inst.arguments_exposed());
+        if (!inst.arguments_exposed())
+            h.add(inst.unexposed_arguments());
+        else if (auto arguments = inst.arguments())
+            for (auto& arg : arguments.value())
+                add_template_argument(h, arg);
+        break;
+    }
+
+    case cpp_type_kind::dependent_t:
+    {
+        auto& dependent = static_cast<const cpp_dependent_type&>(type);
+        h.add(dependent.name()).add(dependent.dependee());
+        break;
+    }
+
+    case cpp_type_kind::unexposed_t:
+        h.add(static_cast<const cpp_unexposed_type&>(type).name());
+        break;
+    }
+    return h.finish();
+}
+
+void add_virtual(hasher& h, const cpp_virtual& virt)
+{
+    h.add(is_virtual(virt)).add(is_pure(virt)).add(is_overriding(virt)).add(is_final(virt));
+}
+
+void add_function_base(hasher& h, const cpp_function_base& func)
+{
+    h.add_children(func.parameters())
+        .add(std::uint_least64_t(func.body_kind()))
+        .add(func.noexcept_condition())
+        .add(func.is_variadic());
+}
+
+void add_member_function_base(hasher& h, const cpp_member_function_base& func)
+{
+    add_function_base(h, func);
+    h.add(func.return_type());
+    add_virtual(h, func.virtual_info());
+    h.add(std::uint_least64_t(func.cv_qualifier()))
+        .add(std::uint_least64_t(func.ref_qualifier()))
+        .add(func.is_constexpr())
+        .add(func.is_consteval());
+}
+
+void add_template(hasher& h, const cpp_template& templ)
+{
+    h.add_children(templ.parameters()).add_children(templ);
+}
+
+void add_template_specialization(hasher& h, const cpp_template_specialization& spec)
+{
+    add_template(h, spec);
+    h.add(spec.primary_template()).add(spec.arguments_exposed());
+    if (spec.arguments_exposed())
+    {
+        for (auto& arg : spec.arguments())
+            add_template_argument(h, arg);
+        h.add(std::uint_least64_t(spec.arguments().size()));
+    }
+    else
+        h.add(spec.unexposed_arguments());
+}
+
+std::uint_least64_t compute_hash(const cpp_entity& e)
+{
+    hasher h;
+    h.add(std::uint_least64_t(e.kind())).add(e.name()).add(e.comment());
+
+    for (auto& attr : e.attributes())
+    {
+        h.add(std::uint_least64_t(attr.kind())).add(attr.name()).add(attr.is_variadic());
+        h.add(attr.scope().has_value()).add(attr.scope().value_or(""));
+        h.add(attr.arguments().has_value());
+        if (attr.arguments())
+            h.add(attr.arguments().value());
+    }
+    h.add(std::uint_least64_t(e.attributes().size()));
+
+    switch (e.kind())
+    {
+    case cpp_entity_kind::file_t:
+        h.add_children(static_cast<const cpp_file&>(e));
+        break;
+
+    case cpp_entity_kind::macro_parameter_t:
+        break;
+    case cpp_entity_kind::macro_definition_t:
+    {
+        auto& macro = static_cast<const cpp_macro_definition&>(e);
+        h.add(macro.replacement())
+            .add(macro.is_function_like())
+            .add(macro.is_variadic())
+            .add_children(macro.parameters());
+        break;
+    }
+    case cpp_entity_kind::include_directive_t:
+    {
+        // not the full path, so it is independent of the include directories
+        auto& include = static_cast<const cpp_include_directive&>(e);
+        h.add(std::uint_least64_t(include.include_kind()));
+        break;
+    }
+
+    case cpp_entity_kind::language_linkage_t:
+    {
+        auto& linkage = static_cast<const cpp_language_linkage&>(e);
+        h.add(linkage.is_block()).add_children(linkage);
+        break;
+    }
+    case cpp_entity_kind::namespace_t:
+    {
+        auto& ns = static_cast<const cpp_namespace&>(e);
+        h.add(ns.is_inline()).add(ns.is_nested()).add(ns.is_anonymous()).add_children(ns);
+        break;
+    }
+    case cpp_entity_kind::namespace_alias_t:
+        h.add(static_cast<const cpp_namespace_alias&>(e).target());
+        break;
+    case cpp_entity_kind::using_directive_t:
+        h.add(static_cast<const cpp_using_directive&>(e).target());
+        break;
+    case cpp_entity_kind::using_declaration_t:
+        h.add(static_cast<const cpp_using_declaration&>(e).target());
+        break;
+
+    case cpp_entity_kind::type_alias_t:
+        h.add(static_cast<const cpp_type_alias&>(e).underlying_type());
+        break;
+
+    case cpp_entity_kind::enum_t:
+    {
+        auto& enum_ = static_cast<const cpp_enum&>(e);
+        h.add(enum_.is_scoped()).add(enum_.is_definition()).add(enum_.has_explicit_type());
+        if (enum_.has_explicit_type())
+            h.add(enum_.underlying_type());
+        h.add_children(enum_);
+        break;
+    }
+    case cpp_entity_kind::enum_value_t:
+        h.add(static_cast<const cpp_enum_value&>(e).value());
+        break;
+
+    case cpp_entity_kind::class_t:
+    {
+        auto& class_ = static_cast<const cpp_class&>(e);
+        h.add(std::uint_least64_t(class_.class_kind()))
+            .add(class_.is_final())
+            .add(class_.is_definition())
+            .add_children(class_.bases())
+            .add_children(class_);
+        break;
+    }
+    case cpp_entity_kind::access_specifier_t:
+        h.add(std::uint_least64_t(static_cast<const cpp_access_specifier&>(e).access_specifier()));
+        break;
+    case cpp_entity_kind::base_class_t:
+    {
+        auto& base = static_cast<const cpp_base_class&>(e);
+        h.add(base.type()).add(std::uint_least64_t(base.access_specifier())).add(base.is_virtual());
+        break;
+    }
+
+    case cpp_entity_kind::variable_t:
+    {
+        auto& var = static_cast<const cpp_variable&>(e);
+        h.add(var.type())
+            .add(var.default_value())
+            .add(std::uint_least64_t(var.storage_class()))
+            .add(var.is_constexpr())
+            .add(var.is_definition());
+        break;
+    }
+    case cpp_entity_kind::member_variable_t:
+    case cpp_entity_kind::bitfield_t:
+    {
+        auto& var = static_cast<const cpp_member_variable_base&>(e);
+        h.add(var.type()).add(var.default_value()).add(var.is_mutable());
+        if (e.kind() == cpp_entity_kind::bitfield_t)
+            h.add(std::uint_least64_t(static_cast<const cpp_bitfield&>(e).no_bits()));
+        break;
+    }
+
+    case cpp_entity_kind::function_parameter_t:
+    {
+        auto& param = static_cast<const cpp_function_parameter&>(e);
+        h.add(param.type()).add(param.default_value());
+        break;
+    }
+    case cpp_entity_kind::function_t:
+    {
+        auto& func = static_cast<const cpp_function&>(e);
+        add_function_base(h, func);
+        h.add(func.return_type())
+            .add(std::uint_least64_t(func.storage_class()))
+            .add(func.is_constexpr())
+            .add(func.is_consteval());
+        break;
+    }
+    case cpp_entity_kind::member_function_t:
+        add_member_function_base(h, static_cast<const cpp_member_function&>(e));
+        break;
+    case cpp_entity_kind::conversion_op_t:
+    {
+        auto& op = static_cast<const cpp_conversion_op&>(e);
+        add_member_function_base(h, op);
+        h.add(op.is_explicit());
+        break;
+    }
+    case cpp_entity_kind::constructor_t:
+    {
+        auto& ctor = static_cast<const cpp_constructor&>(e);
+        add_function_base(h, ctor);
+        h.add(ctor.is_explicit()).add(ctor.is_constexpr()).add(ctor.is_consteval());
+        break;
+    }
+    case cpp_entity_kind::destructor_t:
+    {
+        auto& dtor = static_cast<const cpp_destructor&>(e);
+        add_function_base(h, dtor);
+        add_virtual(h, dtor.virtual_info());
+        break;
+    }
+
+    case cpp_entity_kind::friend_t:
+    {
+        auto& friend_ = static_cast<const cpp_friend&>(e);
+        h.add(friend_.entity()).add(friend_.type());
+        break;
+    }
+
+    case cpp_entity_kind::template_type_parameter_t:
+    {
+        auto& param = static_cast<const cpp_template_type_parameter&>(e);
+        h.add(param.is_variadic())
+            .add(std::uint_least64_t(param.keyword()))
+            .add(param.default_type());
+        break;
+    }
+    case cpp_entity_kind::non_type_template_parameter_t:
+    {
+        auto& param = static_cast<const cpp_non_type_template_parameter&>(e);
+        h.add(param.is_variadic()).add(param.type()).add(param.default_value());
+        break;
+    }
+    case cpp_entity_kind::template_template_parameter_t:
+    {
+        auto& param = static_cast<const cpp_template_template_parameter&>(e);
+        h.add(param.is_variadic())
+            .add(std::uint_least64_t(param.keyword()))
+            .add_children(param.parameters());
+        auto default_template = param.default_template();
+        h.add(default_template.has_value());
+        if (default_template)
+            h.add(default_template.value());
+        break;
+    }
+
+    case cpp_entity_kind::alias_template_t:
+    case cpp_entity_kind::variable_template_t:
+    case cpp_entity_kind::function_template_t:
+    case cpp_entity_kind::class_template_t:
+        add_template(h, static_cast<const cpp_template&>(e));
+        break;
+    case cpp_entity_kind::function_template_specialization_t:
+    case cpp_entity_kind::class_template_specialization_t:
+        add_template_specialization(h, static_cast<const cpp_template_specialization&>(e));
+        break;
+
+    case cpp_entity_kind::static_assert_t:
+    {
+        auto& static_assert_ = static_cast<const cpp_static_assert&>(e);
+        h.add(static_assert_.expression()).add(static_assert_.message());
+        break;
+    }
+
+    case cpp_entity_kind::unexposed_t:
+        h.add(static_cast<const cpp_unexposed_entity&>(e).spelling());
+        break;
+
+    case cpp_entity_kind::count:
+        DEBUG_UNREACHABLE(detail::assert_handler{});
+        break;
+    }
+    return h.finish();
+}
+
+template <typename T>
+std::uint_least64_t get_hash(const T& obj)
+{
+    auto& cache = detail::cpp_structural_hash_access::get(obj);
+    auto  hash  = cache.load(std::memory_order_relaxed);
+    if (hash == 0u)
+    {
+        // concurrent calls compute the same value, so there is no need to synchronize
+        hash = compute_hash(obj);
+        cache.store(hash, std::memory_order_relaxed);
+    }
+    return hash;
+}
+} // namespace
+
+std::uint_least64_t cppast::structural_hash(const cpp_type& type)
+{
+    return get_hash(type);
+}
+
+std::uint_least64_t cppast::structural_hash(const cpp_entity& e)
+{
+    return get_hash(e);
+}
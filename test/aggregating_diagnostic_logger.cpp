@@ -0,0 +1,77 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/aggregating_diagnostic_logger.hpp>
+
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+using namespace cppast;
+
+namespace
+{
+class collecting_logger : public diagnostic_logger
+{
+public:
+    mutable std::vector<std::string> messages;
+
+private:
+    bool do_log(const char*, const diagnostic& d) const override
+    {
+        messages.push_back(d.location.to_string() + " " + d.message);
+        return true;
+    }
+};
+
+diagnostic make_diagnostic(std::string file, unsigned line, std::string msg,
+                           severity sev = severity::warning)
+{
+    return diagnostic{std::move(msg), source_location::make_file(std::move(file), line), sev};
+}
+} // namespace
+
+TEST_CASE("aggregating_diagnostic_logger")
+{
+    collecting_logger             target;
+    aggregating_diagnostic_logger logger(type_safe::ref(target));
+    REQUIRE(&logger.target() == &target);
+
+    REQUIRE(logger.log("test", make_diagnostic("a.hpp", 1u, "noisy")));
+    REQUIRE(!logger.log("test", make_diagnostic("a.hpp", 1u, "noisy")));
+    // differ in file, line, message or severity
+    REQUIRE(logger.log("test", make_diagnostic("b.hpp", 1u, "noisy")));
+    REQUIRE(logger.log("test", make_diagnostic("a.hpp", 2u, "noisy")));
+    REQUIRE(logger.log("test", make_diagnostic("a.hpp", 1u, "other")));
+    REQUIRE(logger.log("test", make_diagnostic("a.hpp", 1u, "noisy", severity::error)));
+
+    std::vector<std::thread> threads;
+    for (auto i = 0u; i != 4u; ++i)
+        threads.emplace_back([&] {
+            for (auto j = 0u; j != 10u; ++j)
+                logger.log("test", make_diagnostic("b.hpp", 1u, "noisy"));
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(target.messages
+            == std::vector<std::string>{"a.hpp:1: noisy", "b.hpp:1: noisy", "a.hpp:2: noisy",
+                                        "a.hpp:1: other", "a.hpp:1: noisy"});
+    REQUIRE(logger.repeats() == 41u);
+
+    auto summary = logger.summary();
+    REQUIRE(summary.size() == 5u);
+    REQUIRE(summary[0u].count == 41u);
+    REQUIRE(summary[0u].diag.location.file.value() == "b.hpp");
+    REQUIRE(summary[1u].count == 2u);
+    REQUIRE(summary[1u].diag.location.file.value() == "a.hpp");
+    REQUIRE(summary[1u].diag.message == "noisy");
+    REQUIRE(summary[1u].diag.severity == severity::warning);
+    REQUIRE(summary[2u].count == 1u);
+
+    target.messages.clear();
+    REQUIRE(logger.log_summary() == 2u);
+    REQUIRE(target.messages
+            == std::vector<std::string>{"b.hpp:1: warning 'noisy' reported 41 times",
+                                        "a.hpp:1: warning 'noisy' reported 2 times"});
+}
@@ -0,0 +1,94 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/buffered_diagnostic_logger.hpp>
+
+#include <stdexcept>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+using namespace cppast;
+
+namespace
+{
+class collecting_logger : public diagnostic_logger
+{
+public:
+    mutable std::vector<std::string> messages;
+
+private:
+    bool do_log(const char*, const diagnostic& d) const override
+    {
+        messages.push_back(d.location.to_string() + " " + d.message);
+        return true;
+    }
+};
+
+diagnostic make_diagnostic(std::string file, unsigned line, std::string msg)
+{
+    return diagnostic{std::move(msg), source_location::make_file(std::move(file), line),
+                      severity::warning};
+}
+} // namespace
+
+TEST_CASE("buffered_diagnostic_logger")
+{
+    collecting_logger target;
+
+    SECTION("deterministic order")
+    {
+        buffered_diagnostic_logger logger(type_safe::ref(target));
+        REQUIRE(&logger.target() == &target);
+
+        std::vector<std::thread> threads;
+        for (auto i = 0u; i != 4u; ++i)
+            threads.emplace_back([&, i] {
+                logger.log("test", make_diagnostic("b.cpp", 4u - i, "b" + std::to_string(i)));
+                logger.log("test", make_diagnostic("a.cpp", i + 1u, "a" + std::to_string(i)));
+            });
+        for (auto& thread : threads)
+            thread.join();
+        logger.log("test", diagnostic{"none", source_location::make_unknown(), severity::error});
+
+        // nothing is emitted before flushing
+        REQUIRE(target.messages.empty());
+
+        REQUIRE(logger.flush() == 9u);
+        REQUIRE(target.messages
+                == std::vector<std::string>{" none", "a.cpp:1: a0", "a.cpp:2: a1", "a.cpp:3: a2",
+                                            "a.cpp:4: a3", "b.cpp:1: b3", "b.cpp:2: b2",
+                                            "b.cpp:3: b1", "b.cpp:4: b0"});
+
+        REQUIRE(logger.flush() == 0u);
+        REQUIRE(target.messages.size() == 9u);
+    }
+    SECTION("destructor flushes")
+    {
+        {
+            buffered_diagnostic_logger logger(type_safe::ref(target));
+            logger.log("test", make_diagnostic("a.cpp", 1u, "a"));
+            logger.log("test", diagnostic{"debug", source_location::make_unknown(),
+                                          severity::debug});
+        }
+        // the debug diagnostic isn't logged, as the target isn't verbose
+        REQUIRE(target.messages == std::vector<std::string>{"a.cpp:1: a"});
+    }
+    SECTION("destructor doesn't throw")
+    {
+        class throwing_logger : public diagnostic_logger
+        {
+            bool do_log(const char*, const diagnostic&) const override
+            {
+                throw std::runtime_error("log failed");
+            }
+        } throwing;
+
+        {
+            buffered_diagnostic_logger logger(type_safe::ref(throwing));
+            logger.log("test", make_diagnostic("a.cpp", 1u, "a"));
+            logger.log("test", make_diagnostic("b.cpp", 1u, "b"));
+        }
+        REQUIRE(target.messages.empty());
+    }
+}
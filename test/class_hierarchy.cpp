@@ -0,0 +1,83 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/class_hierarchy.hpp>
+
+#include <algorithm>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+TEST_CASE("class_hierarchy")
+{
+    cpp_entity_index idx;
+    auto             file = parse(idx, "class_hierarchy.cpp", R"(
+struct d;
+
+struct a {};
+struct b : a {};
+using b_alias = b;
+struct c : b_alias {};
+struct d : a, c {};
+
+template <typename T>
+struct e : T {};
+
+struct f {};
+)");
+
+    class_hierarchy hierarchy(idx);
+    REQUIRE(hierarchy.size() == 6u);
+
+    auto get_class = [&](const char* name) -> const cpp_class& {
+        for (auto& c : hierarchy.classes())
+            if (c->name() == name)
+                return *c;
+        FAIL("class not found");
+        return *hierarchy.classes().front();
+    };
+    auto get_names = [](const std::vector<type_safe::object_ref<const cpp_class>>& classes) {
+        std::vector<std::string> result;
+        for (auto& c : classes)
+            result.push_back(c->name());
+        return result;
+    };
+
+    auto& a = get_class("a");
+    auto& b = get_class("b");
+    auto& c = get_class("c");
+    auto& d = get_class("d");
+    auto& e = get_class("e");
+    auto& f = get_class("f");
+
+    // topological order
+    for (auto i = std::size_t(0); i != hierarchy.size(); ++i)
+        for (auto& base : hierarchy.bases(*hierarchy.classes()[i]))
+        {
+            auto iter = std::find_if(hierarchy.classes().begin(), hierarchy.classes().end(),
+                                     [&](type_safe::object_ref<const cpp_class> cur) {
+                                         return &*cur == &*base;
+                                     });
+            REQUIRE(std::size_t(iter - hierarchy.classes().begin()) < i);
+        }
+
+    REQUIRE(get_names(hierarchy.direct_bases(d)) == std::vector<std::string>{"a", "c"});
+    REQUIRE(get_names(hierarchy.direct_bases(c)) == std::vector<std::string>{"b"});
+    REQUIRE(hierarchy.direct_bases(e).empty());
+    REQUIRE(get_names(hierarchy.direct_derived_classes(a))
+            == std::vector<std::string>{"b", "d"});
+
+    REQUIRE(get_names(hierarchy.bases(d)) == std::vector<std::string>{"a", "b", "c"});
+    REQUIRE(get_names(hierarchy.derived_classes(a)) == std::vector<std::string>{"b", "c", "d"});
+    REQUIRE(get_names(hierarchy.derived_classes(c)) == std::vector<std::string>{"d"});
+    REQUIRE(hierarchy.bases(f).empty());
+    REQUIRE(hierarchy.derived_classes(f).empty());
+
+    REQUIRE(hierarchy.is_derived_from(d, a));
+    REQUIRE(hierarchy.is_derived_from(d, b));
+    REQUIRE(hierarchy.is_derived_from(c, a));
+    REQUIRE(!hierarchy.is_derived_from(a, d));
+    REQUIRE(!hierarchy.is_derived_from(a, a));
+    REQUIRE(!hierarchy.is_derived_from(f, a));
+}
@@ -252,3 +252,213 @@ void func2()noexcept(excluded);
         REQUIRE(generator.str() == synopsis);
     }
 }
+
+TEST_CASE("buffered_code_generator")
+{
+    auto code = R"(namespace ns{
+  struct foo{
+    using my_int=int;
+
+    my_int a;
+
+    void func(int)noexcept;
+
+  private:
+    int const b=42;
+  };
+
+  enum class bar
+  :int{
+    a,
+    b=42
+  };
+}
+
+template<typename T>
+T var;)";
+    auto file = parse({}, "buffered_code_generator.cpp", code);
+
+    buffered_code_generator generator(2u);
+    REQUIRE(generate_code(generator, *file));
+    REQUIRE(generator.str() == get_code(*file) + "\n");
+
+    auto result = generator.release();
+    REQUIRE(result == get_code(*file) + "\n");
+    REQUIRE(generator.str().empty());
+
+    // generates the same code again
+    generate_code(generator, *file);
+    REQUIRE(generator.str() == result);
+}
+
+namespace
+{
+// customizes a generator the same way, regardless of whether it is buffered or not
+template <class Generator>
+class customized_generator : public Generator
+{
+public:
+    template <typename... Args>
+    explicit customized_generator(Args&&... args) : Generator(std::forward<Args>(args)...)
+    {}
+
+    std::vector<std::string> excluded;
+
+private:
+    formatting do_get_formatting() const override
+    {
+        return formatting_flags::comma_ws;
+    }
+
+    code_generator::generation_options do_get_options(const cpp_entity& e,
+                                                      cpp_access_specifier_kind) override
+    {
+        if (e.name() == "b")
+            return code_generator::exclude;
+        else if (e.name() == "t")
+            return code_generator::exclude_target;
+        return {};
+    }
+
+    void do_write_excluded(const cpp_entity& e) override
+    {
+        excluded.push_back(e.name());
+    }
+
+    void on_begin(const code_generator::output& out, const cpp_entity& e) override
+    {
+        if (e.name() == "foo")
+            out << token_seq("// begin foo") << newl;
+    }
+
+    void on_end(const code_generator::output& out, const cpp_entity& e) override
+    {
+        if (e.name() == "foo")
+            out << token_seq("// end foo") << newl;
+    }
+
+    void on_container_end(const code_generator::output& out, const cpp_entity& e) override
+    {
+        if (e.name() == "ns")
+            out << token_seq("// end ns") << newl;
+    }
+};
+} // namespace
+
+TEST_CASE("buffered_code_generator customization")
+{
+    auto code = R"(
+namespace ns
+{
+    struct foo
+    {
+        int a;
+        int b;
+    };
+
+    void f(int a, int c, int b);
+}
+
+using t = int;
+)";
+    auto file = parse({}, "buffered_code_generator_customization.cpp", code);
+
+    customized_generator<test_generator> unbuffered(code_generator::generation_options{});
+    generate_code(unbuffered, *file);
+
+    customized_generator<buffered_code_generator> buffered(2u);
+    REQUIRE(generate_code(buffered, *file));
+    REQUIRE(buffered.str() == unbuffered.str());
+    REQUIRE(buffered.excluded == unbuffered.excluded);
+
+    auto& str = buffered.str();
+    INFO(str);
+    REQUIRE(str.find("// begin foo\n  struct foo{") != std::string::npos);
+    REQUIRE(str.find("// end foo") != std::string::npos);
+    REQUIRE(str.find("// end ns") != std::string::npos);
+    REQUIRE(str.find("int b") == std::string::npos);
+    REQUIRE(str.find("void f(int a, int c);") != std::string::npos);
+    REQUIRE(str.find("using t=;") != std::string::npos);
+    REQUIRE(buffered.excluded == std::vector<std::string>{"t"});
+}
+
+TEST_CASE("generate_code_parallel")
+{
+    auto code = R"(using a=int;
+
+struct foo{
+  int b;
+};
+
+namespace ns{
+  void c();
+}
+
+enum d{
+  e
+};)";
+    auto file = parse({}, "generate_code_parallel.cpp", code);
+
+    buffered_code_generator_factory factory = [] {
+        return std::unique_ptr<buffered_code_generator>(new buffered_code_generator(2u));
+    };
+
+    buffered_code_generator generator(2u);
+    generate_code(generator, *file);
+    for (auto thread_count : {0u, 1u, 3u})
+        REQUIRE(generate_code_parallel(factory, *file, thread_count) == generator.str());
+
+    std::vector<type_safe::object_ref<const cpp_entity>> entities;
+    for (auto& child : *file)
+        entities.push_back(type_safe::ref(child));
+
+    auto result = generate_code_parallel(factory, entities, 2u);
+    REQUIRE(result.size() == entities.size());
+    for (auto i = 0u; i != entities.size(); ++i)
+    {
+        buffered_code_generator single(2u);
+        generate_code(single, *entities[i]);
+        REQUIRE(result[i] == single.str());
+    }
+
+    SECTION("excluded and custom entities")
+    {
+        class custom_generator final : public buffered_code_generator
+        {
+        public:
+            custom_generator() : buffered_code_generator(2u) {}
+
+        private:
+            generation_options do_get_options(const cpp_entity& e,
+                                              cpp_access_specifier_kind) override
+            {
+                if (e.name() == "foo")
+                    return code_generator::exclude;
+                else if (e.name() == "ns")
+                    return code_generator::custom;
+                return {};
+            }
+
+            void on_begin(const output& out, const cpp_entity& e) override
+            {
+                if (e.name() == "ns")
+                    out << token_seq("// ns") << newl;
+            }
+        };
+
+        buffered_code_generator_factory custom_factory = [] {
+            return std::unique_ptr<buffered_code_generator>(new custom_generator());
+        };
+
+        custom_generator sequential;
+        generate_code(sequential, *file);
+        REQUIRE(sequential.str() == "using a=int;\n\n// ns\nenum d{\n  e\n};\n");
+        for (auto thread_count : {1u, 3u})
+            REQUIRE(generate_code_parallel(custom_factory, *file, thread_count)
+                    == sequential.str());
+
+        // the custom code is kept for the single entities as well
+        auto custom_result = generate_code_parallel(custom_factory, entities, 2u);
+        REQUIRE(custom_result[2u] == "// ns\n");
+    }
+}
@@ -2,6 +2,10 @@
 // SPDX-License-Identifier: MIT
 
 #include <cppast/cpp_class.hpp>
+#include <cppast/cpp_class_template.hpp>
+#include <cppast/cpp_enum.hpp>
+#include <cppast/cpp_member_function.hpp>
+#include <cppast/cpp_namespace.hpp>
 
 #include "test_parser.hpp"
 
@@ -307,3 +311,112 @@ struct g
     });
     REQUIRE(count == 13u);
 }
+
+TEST_CASE("cpp_class find_members")
+{
+    cpp_entity_index idx;
+    auto             file = parse(idx, "cpp_class_find_members.cpp", R"(
+struct a
+{
+    void f();
+    int g;
+    void f(int);
+    template <typename T>
+    void h(T);
+    void h(int);
+};
+
+enum class b
+{
+    x,
+    y,
+};
+)");
+
+    auto& a = static_cast<const cpp_class&>(*file->begin());
+    REQUIRE(a.name() == "a");
+
+    auto f = a.find_members("f");
+    REQUIRE(f.size() == 2u);
+    REQUIRE(f[0u]->kind() == cpp_entity_kind::member_function_t);
+    REQUIRE(static_cast<const cpp_member_function&>(*f[0u]).parameters().empty());
+    REQUIRE(!static_cast<const cpp_member_function&>(*f[1u]).parameters().empty());
+
+    REQUIRE(a.find_members("g").size() == 1u);
+    REQUIRE(a.find_members("x").size() == 0u);
+
+    auto h = a.find_members("h");
+    REQUIRE(h.size() == 2u);
+    REQUIRE(h[0u]->kind() == cpp_entity_kind::function_template_t);
+    REQUIRE(h[1u]->kind() == cpp_entity_kind::member_function_t);
+
+    auto& b = static_cast<const cpp_enum&>(*std::next(file->begin()));
+    REQUIRE(b.find_members("y").size() == 1u);
+    REQUIRE(&*b.find_members("y")[0u] == &*std::next(b.begin()));
+    REQUIRE(b.find_members("z").size() == 0u);
+}
+
+TEST_CASE("cpp_class qualified_name")
+{
+    cpp_entity_index idx;
+    auto             file = parse(idx, "cpp_class_qualified_name.cpp", R"(
+namespace ns
+{
+    struct a
+    {
+        struct b;
+        void f();
+    };
+
+    template <typename T>
+    struct c
+    {
+        int d;
+    };
+
+    namespace
+    {
+        struct e {};
+    }
+}
+
+struct ns::a::b
+{
+    int g;
+};
+
+void ns::a::f() {}
+)");
+
+    auto& ns = static_cast<const cpp_namespace&>(*file->begin());
+    REQUIRE(scope_path(ns).empty());
+    REQUIRE(qualified_name(ns) == "ns");
+
+    auto& a = static_cast<const cpp_class&>(*ns.begin());
+    REQUIRE(scope_path(a) == "ns::");
+    REQUIRE(qualified_name(a) == "ns::a");
+    REQUIRE(qualified_name(*a.find_members("f")[0u]) == "ns::a::f");
+    // cached
+    REQUIRE(&qualified_name(a) == &qualified_name(a));
+    REQUIRE(&scope_path(*a.find_members("b")[0u]) == &scope_path(*a.find_members("f")[0u]));
+
+    auto& c = static_cast<const cpp_class_template&>(*std::next(ns.begin()));
+    REQUIRE(qualified_name(c) == "ns::c");
+    REQUIRE(qualified_name(c.class_()) == "ns::c");
+    REQUIRE(qualified_name(*c.class_().begin()) == "ns::c::d");
+
+    auto& anonymous = static_cast<const cpp_namespace&>(*std::next(ns.begin(), 2));
+    REQUIRE(qualified_name(*anonymous.begin()) == "ns::e");
+
+    auto& b = static_cast<const cpp_class&>(*std::next(file->begin()));
+    REQUIRE(scope_path(b).empty());
+    REQUIRE(qualified_name(b) == "ns::a::b");
+    REQUIRE(scope_path(*b.begin()) == "ns::a::b::");
+    REQUIRE(qualified_name(*b.begin()) == "ns::a::b::g");
+
+    // out of line definitions are qualified by their semantic scope
+    auto& f = *std::next(file->begin(), 2);
+    REQUIRE(f.kind() == cpp_entity_kind::member_function_t);
+    REQUIRE(scope_path(f).empty());
+    REQUIRE(qualified_name(f) == "ns::a::f");
+}
@@ -0,0 +1,166 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/cpp_entity_index.hpp>
+
+#include <cppast/cpp_namespace.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+TEST_CASE("cpp_entity_index")
+{
+    cpp_entity_index idx;
+    auto             file = parse(idx, "cpp_entity_index.cpp", R"(
+namespace ns { struct a; }
+namespace ns { struct a {}; }
+
+void b();
+)");
+
+    auto check_lookup = [&] {
+        auto a = idx.lookup("c:@N@ns@S@a"_id);
+        REQUIRE(a);
+        REQUIRE(a.value().name() == "a");
+        REQUIRE(is_definition(a.value()));
+        REQUIRE(&idx.lookup_definition("c:@N@ns@S@a"_id).value() == &a.value());
+
+        auto b = idx.lookup("c:@F@b#"_id);
+        REQUIRE(b);
+        REQUIRE(!idx.lookup_definition("c:@F@b#"_id));
+
+        REQUIRE(idx.lookup_namespace("c:@N@ns"_id).size() == 2u);
+        REQUIRE(idx.lookup_namespace("c:@N@other"_id).size() == 0u);
+        REQUIRE(!idx.lookup("c:@F@c#"_id));
+
+        REQUIRE(&idx.lookup(cpp_entity_id(file->name())).value() == file.get());
+    };
+
+    REQUIRE(!idx.is_frozen());
+    check_lookup();
+    auto namespaces = idx.lookup_namespace("c:@N@ns"_id);
+
+    idx.freeze();
+    REQUIRE(idx.is_frozen());
+    check_lookup();
+
+    // references from before freezing stay valid
+    REQUIRE(namespaces.data() == idx.lookup_namespace("c:@N@ns"_id).data());
+    REQUIRE(namespaces[0u]->name() == "ns");
+
+    auto& ns = static_cast<const cpp_namespace&>(*file->begin());
+    REQUIRE_THROWS_AS(idx.register_namespace("c:@N@ns"_id, type_safe::ref(ns)),
+                      cpp_entity_index::frozen_index_error);
+    REQUIRE_THROWS_AS(idx.register_forward_declaration("c:@F@c#"_id, type_safe::ref(ns)),
+                      cpp_entity_index::frozen_index_error);
+    REQUIRE(idx.lookup_namespace("c:@N@ns"_id).size() == 2u);
+
+    idx.freeze();
+    check_lookup();
+}
+
+TEST_CASE("cpp_entity_index batch")
+{
+    cpp_entity_index idx;
+    auto             file = parse(idx, "cpp_entity_index_batch.cpp", R"(
+namespace ns {}
+struct a;
+struct b {};
+)");
+
+    auto  iter = file->begin();
+    auto& ns   = static_cast<const cpp_namespace&>(*iter++);
+    auto& a    = *iter++;
+    auto& b    = *iter++;
+
+    cpp_entity_index other;
+    {
+        cpp_entity_index::registration_batch batch(other);
+        other.register_namespace("ns"_id, type_safe::ref(ns));
+        other.register_forward_declaration("a"_id, type_safe::ref(a));
+        other.register_forward_declaration("b"_id, type_safe::ref(a));
+        other.register_definition("b"_id, type_safe::ref(b));
+        REQUIRE(batch.size() == 4u);
+
+        // not registered yet
+        REQUIRE(!other.lookup("a"_id));
+        REQUIRE(other.lookup_namespace("ns"_id).size() == 0u);
+
+        other.register_batch(batch);
+        REQUIRE(batch.size() == 0u);
+        REQUIRE(batch.is_committed());
+
+        // the committed batch doesn't buffer anymore
+        other.register_definition("c"_id, type_safe::ref(b));
+        REQUIRE(batch.size() == 0u);
+        REQUIRE(&other.lookup("c"_id).value() == &b);
+    }
+    REQUIRE(&other.lookup("c"_id).value() == &b);
+
+    {
+        // a duplicate definition discards the entire batch
+        cpp_entity_index::registration_batch batch(other);
+        other.register_definition("d"_id, type_safe::ref(b));
+        other.register_definition("b"_id, type_safe::ref(b));
+        REQUIRE_THROWS_AS(other.register_batch(batch),
+                          cpp_entity_index::duplicate_definition_error);
+        REQUIRE(batch.size() == 2u);
+    }
+    REQUIRE(!other.lookup("d"_id));
+
+    REQUIRE(&other.lookup("a"_id).value() == &a);
+    REQUIRE(!other.lookup_definition("a"_id));
+    REQUIRE(&other.lookup_definition("b"_id).value() == &b);
+    REQUIRE(other.lookup_namespace("ns"_id).size() == 1u);
+
+    std::vector<cpp_entity_id> ids{"b"_id, "d"_id, "a"_id};
+    auto result = other.lookup_many(type_safe::ref(ids.data(), ids.size()));
+    REQUIRE(result.size() == 3u);
+    REQUIRE(&result[0].value() == &b);
+    REQUIRE(!result[1]);
+    REQUIRE(&result[2].value() == &a);
+}
+
+TEST_CASE("cpp_entity_id")
+{
+    // computed at compile time
+    constexpr auto id = "c:@N@ns@S@a_name_longer_than_one_block"_id;
+    REQUIRE(id == cpp_entity_id("c:@N@ns@S@a_name_longer_than_one_block"));
+    REQUIRE(id == cpp_entity_id(std::string("c:@N@ns@S@a_name_longer_than_one_block")));
+    REQUIRE(id != "c:@N@ns@S@a_name_longer_than_one_block_"_id);
+
+    for (auto length = std::size_t(0); length != 40u; ++length)
+    {
+        std::string str(length, 'a');
+        REQUIRE(cpp_entity_id(str.c_str(), str.size()) == cpp_entity_id(str));
+    }
+
+    cpp_entity_index idx;
+    idx.enable_id_verification();
+    {
+        cpp_entity_index::id_verification verification(idx);
+        REQUIRE(cpp_entity_id("a") == cpp_entity_id(std::string("a")));
+        REQUIRE(cpp_entity_id("b") != cpp_entity_id("a"));
+        // the check must not report false positives
+        REQUIRE_NOTHROW(cpp_entity_id("c:@F@b#"));
+        REQUIRE_NOTHROW(cpp_entity_id("c:@F@b#"));
+
+        // fake a collision, as there are no known strings that actually collide
+        auto hash = static_cast<detail::hash_type>(cpp_entity_id("c:@F@b#"));
+        REQUIRE_NOTHROW(detail::verify_id_hash(idx, hash, "c:@F@b#", 7u));
+        REQUIRE_THROWS_AS(detail::verify_id_hash(idx, hash, "c:@F@c#", 7u),
+                          cpp_entity_id_collision_error);
+        REQUIRE_THROWS_AS(detail::verify_id_hash(idx, hash, "c:@F@b", 6u),
+                          cpp_entity_id_collision_error);
+    }
+    // literals are checked on lookup
+    REQUIRE_NOTHROW(idx.lookup("c:@F@b#"_id));
+    REQUIRE(!idx.lookup_definition("c:@F@c#"_id));
+    REQUIRE(idx.lookup_namespace("c:@N@ns"_id).size() == 0u);
+
+    // an index without verification doesn't affect the ids
+    cpp_entity_index other;
+    cpp_entity_index::id_verification verification(other);
+    REQUIRE(cpp_entity_id("a") == "a"_id);
+}
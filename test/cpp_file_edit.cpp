@@ -0,0 +1,99 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/cpp_file_edit.hpp>
+
+#include <cppast/cpp_type_alias.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+namespace
+{
+std::string get_code(const cpp_file_edit& e)
+{
+    test_generator generator({});
+    generate_code(generator, e);
+    auto str = generator.str();
+    if (!str.empty() && str.back() == '\n')
+        str.pop_back();
+    return str;
+}
+
+std::unique_ptr<cpp_entity> build_alias(std::string name, cpp_builtin_type_kind kind)
+{
+    return cpp_type_alias::build(std::move(name), cpp_builtin_type::build(kind));
+}
+} // namespace
+
+TEST_CASE("cpp_file_edit")
+{
+    auto code = R"(using a=int;
+
+using b=int;
+
+struct foo{
+  using c=int;
+
+  int d;
+};)";
+    auto file = parse({}, "cpp_file_edit.cpp", code);
+
+    auto& a   = *file->find_members("a")[0u];
+    auto& b   = *file->find_members("b")[0u];
+    auto& foo = static_cast<const cpp_class&>(*file->find_members("foo")[0u]);
+    auto& c   = *foo.find_members("c")[0u];
+    auto& d   = *foo.find_members("d")[0u];
+
+    auto e = edit(*file);
+    REQUIRE(&e.original() == file.get());
+    REQUIRE(e.empty());
+    REQUIRE(get_code(e) == code);
+
+    e.remove(a)
+        .replace(b, build_alias("b", cpp_float))
+        .insert_before(foo, build_alias("f", cpp_int))
+        .insert_after(c, build_alias("e", cpp_int))
+        .insert_after(c, build_alias("g", cpp_int));
+    REQUIRE(e.size() == 4u);
+    REQUIRE(e.is_modified(a));
+    REQUIRE(!e.is_modified(d));
+
+    REQUIRE(!e.lookup(a));
+    REQUIRE(e.lookup(b).value().name() == "b");
+    REQUIRE(&e.lookup(b).value() != &b);
+    REQUIRE(&e.lookup(b).value().parent().value() == file.get());
+    REQUIRE(&e.lookup(d).value() == &d);
+    REQUIRE(e.inserted_before(foo).size() == 1u);
+    REQUIRE(e.inserted_after(c).size() == 2u);
+    REQUIRE(&e.inserted_after(c).back()->parent().value() == &foo);
+    REQUIRE(e.inserted_after(d).empty());
+
+    REQUIRE(get_code(e) == R"(using b=float;
+
+using f=int;
+
+struct foo{
+  using c=int;
+
+  using e=int;
+
+  using g=int;
+
+  int d;
+};)");
+
+    // the original file is unchanged
+    REQUIRE(get_code(*file) == code);
+
+    // a buffered generator is written to directly
+    buffered_code_generator buffered(2u);
+    REQUIRE(generate_code(buffered, e));
+    REQUIRE(buffered.str() == get_code(e) + "\n");
+
+    // replacing a removed entity restores it
+    e.replace(a, build_alias("a", cpp_char));
+    REQUIRE(e.lookup(a).value().name() == "a");
+    REQUIRE(get_code(e).compare(0, 14, "using a=char;\n") == 0);
+}
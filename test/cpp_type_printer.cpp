@@ -0,0 +1,138 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/cpp_type_printer.hpp>
+
+#include <cppast/cpp_type_alias.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+namespace
+{
+// writes the type using a code generator, replacing `T` by `float` if requested
+std::string generate_type(const cpp_type_alias& alias, bool substitute = false)
+{
+    class generator : public code_generator
+    {
+    public:
+        explicit generator(bool subst) : substitute_(subst) {}
+
+        std::string result;
+
+    private:
+        void do_indent() override {}
+        void do_unindent() override {}
+
+        void do_write_token_seq(string_view tokens) override
+        {
+            if (substitute_ && std::string(tokens.c_str()) == "T")
+                result += "float";
+            else
+                result += tokens.c_str();
+        }
+
+        bool substitute_;
+    } gen(substitute);
+
+    code_generator::output output(type_safe::ref(gen), type_safe::ref(alias), cpp_public);
+    detail::write_type(output, alias.underlying_type(), "");
+    return gen.result;
+}
+} // namespace
+
+TEST_CASE("cpp_type_printer")
+{
+    auto code = R"(
+struct foo { int member; void func(int) const&; };
+
+template <typename T, int N>
+struct bar
+{
+    using a = const T*;
+    using b = T (&)[N];
+    using c = bar<T, N + 1>;
+};
+
+using d = int;
+using e = const volatile unsigned long long* const;
+using f = foo&&;
+using g = int (*)(const char*, ...);
+using h = void (foo::*)(int) const&;
+using i = int foo::*;
+using j = decltype(sizeof(int));
+using k = int[4][2];
+using l = bar<int, 4>;
+using m = bar<foo, 2 * 2>*;
+)";
+    auto file = parse({}, "cpp_type_printer.cpp", code);
+
+    cpp_type_printer printer;
+    auto             count = 0u;
+    visit(*file, [&](const cpp_entity& e, visitor_info) {
+        if (e.kind() == cpp_entity_kind::type_alias_t)
+        {
+            auto& alias = static_cast<const cpp_type_alias&>(e);
+            INFO(alias.name());
+            REQUIRE(printer.print(alias.underlying_type()) == generate_type(alias));
+            REQUIRE(to_string(alias.underlying_type()) == generate_type(alias));
+            ++count;
+        }
+        return true;
+    });
+    REQUIRE(count == 13u);
+
+    SECTION("buffer and cache")
+    {
+        auto& alias    = static_cast<const cpp_type_alias&>(*file->find_members("e")[0u]);
+        auto  expected = generate_type(alias);
+
+        cpp_type_printer cached_printer(true);
+
+        std::string buffer = "x ";
+        cached_printer.write(buffer, alias.underlying_type());
+        cached_printer.write(buffer, alias.underlying_type());
+        REQUIRE(buffer == "x " + expected + expected);
+    }
+    SECTION("substitution")
+    {
+        auto substitute = [](void* data, string_view token) -> const std::string* {
+            auto& replacement = *static_cast<const std::string*>(data);
+            return std::string(token.c_str(), token.length()) == "T" ? &replacement : nullptr;
+        };
+        std::string      replacement = "float";
+        cpp_type_printer subst_printer(substitute, &replacement);
+
+        auto count = 0u;
+        visit(*file, [&](const cpp_entity& e, visitor_info) {
+            if (e.kind() == cpp_entity_kind::type_alias_t)
+            {
+                auto& alias = static_cast<const cpp_type_alias&>(e);
+                INFO(alias.name());
+                REQUIRE(subst_printer.print(alias.underlying_type())
+                        == generate_type(alias, true));
+                ++count;
+            }
+            return true;
+        });
+        REQUIRE(count == 13u);
+    }
+    SECTION("references")
+    {
+        auto callback = [](void* data, type_safe::array_ref<const cpp_entity_id>,
+                           string_view name) {
+            static_cast<std::vector<std::string>*>(data)->emplace_back(name.c_str(),
+                                                                        name.length());
+        };
+        std::vector<std::string> names;
+        cpp_type_printer         ref_printer(true);
+        ref_printer.set_reference_callback(callback, &names);
+
+        // the cache isn't used, so the references are reported every time
+        auto& alias = static_cast<const cpp_type_alias&>(*file->find_members("m")[0u]);
+        REQUIRE(ref_printer.print(alias.underlying_type()) == generate_type(alias));
+        REQUIRE(ref_printer.print(alias.underlying_type()) == generate_type(alias));
+        REQUIRE(names == std::vector<std::string>{"bar", "foo", "bar", "foo"});
+    }
+}
@@ -6,6 +6,13 @@
 #include <cppast/libclang_parser.hpp>
 
 #include <fstream>
+#include <map>
+
+#include <cppast/cpp_member_variable.hpp>
+#include <cppast/cpp_template.hpp>
+#include <cppast/cpp_variable.hpp>
+
+#include "test_parser.hpp"
 
 using namespace cppast;
 
@@ -105,4 +112,368 @@ TEST_CASE("libclang_compile_config")
 
     libclang_compile_config c(database, CPPAST_DETAIL_DRIVE "/c.cpp");
     require_flags(c, "-std=c++14 -fms-extensions -fms-compatibility -fno-strict-aliasing");
+
+    json_compilation_database json_database(".");
+    REQUIRE(json_database.files()
+            == std::vector<std::string>{CPPAST_DETAIL_DRIVE "/foo/a.cpp",
+                                        CPPAST_DETAIL_DRIVE "/b.cpp", CPPAST_DETAIL_DRIVE "/b.cpp",
+                                        CPPAST_DETAIL_DRIVE "/c.cpp"});
+    REQUIRE(json_database.has_config(CPPAST_DETAIL_DRIVE "/foo/a.cpp"));
+    REQUIRE(json_database.has_config(CPPAST_DETAIL_DRIVE "/bar/../foo/./a.cpp"));
+    REQUIRE(!json_database.has_config(CPPAST_DETAIL_DRIVE "/foo/d.cpp"));
+
+    auto require_same_flags = [&](const char* file) {
+        libclang_compile_config json_config(json_database, file);
+        REQUIRE(detail::libclang_compile_config_access::flags(json_config)
+                == detail::libclang_compile_config_access::flags(
+                    libclang_compile_config(database, file)));
+    };
+    require_same_flags(CPPAST_DETAIL_DRIVE "/foo/a.cpp");
+    require_same_flags(CPPAST_DETAIL_DRIVE "/b.cpp");
+    require_same_flags(CPPAST_DETAIL_DRIVE "/c.cpp");
+
+    auto header = find_config_for(json_database, CPPAST_DETAIL_DRIVE "/foo/a.hpp");
+    REQUIRE(header);
+    require_flags(header.value(), "-I" CPPAST_DETAIL_DRIVE "/foo/relative -I" CPPAST_DETAIL_DRIVE
+                                  "/absolute -DA=FOO -DB(X)=X");
+}
+
+TEST_CASE("libclang_parser::parse_pipelined")
+{
+    write_file("parse_pipelined_a.cpp", "int a;\nstruct foo {};\n");
+    write_file("parse_pipelined_b.cpp", "#define B 42\nvoid b(int i = B);\n");
+    write_file("parse_pipelined_c.cpp", "namespace c { using d = int; }\n");
+    std::vector<std::string> paths = {"parse_pipelined_a.cpp", "parse_pipelined_b.cpp",
+                                      "parse_pipelined_c.cpp"};
+
+    libclang_compile_config config;
+    config.set_flags(cpp_standard::cpp_latest);
+    libclang_parser parser(default_logger());
+
+    for (auto queue_size : {0u, 1u, 4u})
+    {
+        cpp_entity_index idx;
+        auto             files = parser.parse_pipelined(idx, paths, config, queue_size);
+        REQUIRE(!parser.error());
+        REQUIRE(files.size() == paths.size());
+
+        cpp_entity_index sequential_idx;
+        for (auto i = 0u; i != paths.size(); ++i)
+        {
+            REQUIRE(files[i]);
+            auto sequential = parser.parse(sequential_idx, paths[i], config);
+            REQUIRE(get_code(*files[i]) == get_code(*sequential));
+        }
+        REQUIRE(idx.lookup_definition("c:@S@foo"_id));
+    }
+
+    paths.push_back("parse_pipelined_missing.cpp");
+    cpp_entity_index idx;
+    REQUIRE_THROWS_AS(parser.parse_pipelined(idx, paths, config), libclang_error);
+}
+
+TEST_CASE("libclang_shared_config")
+{
+    libclang_compile_config config;
+    config.set_flags(cpp_standard::cpp_14);
+    config.define_macro("FOO", "42");
+
+    libclang_shared_config a(config);
+    auto& flags = detail::libclang_compile_config_access::flags(config);
+    REQUIRE(a.arguments().size() == flags.size() + 3u);
+    REQUIRE(std::string(a.arguments().back()) == "-DFOO=42");
+
+    // copies share the snapshot
+    auto copy = a;
+    REQUIRE(&copy.config() == &a.config());
+    REQUIRE(copy.arguments().data() == a.arguments().data());
+
+    // equal configurations have the same fingerprint
+    libclang_shared_config b(config);
+    REQUIRE(&b.config() != &a.config());
+    REQUIRE(b.fingerprint() == a.fingerprint());
+    REQUIRE(b == a);
+
+    auto interned = libclang_shared_config::intern(config);
+    REQUIRE(&libclang_shared_config::intern(config).config() == &interned.config());
+    REQUIRE(interned == a);
+
+    config.define_macro("BAR", "");
+    libclang_shared_config c(config);
+    REQUIRE(c.fingerprint() != a.fingerprint());
+    REQUIRE(c != a);
+    REQUIRE(&libclang_shared_config::intern(config).config() != &interned.config());
+
+    write_file("libclang_shared_config.cpp", "int a = FOO;\n");
+    cpp_entity_index idx;
+    libclang_parser  parser(default_logger());
+    auto             file = parser.parse(idx, "libclang_shared_config.cpp", a);
+    REQUIRE(!parser.error());
+    REQUIRE(file);
+    REQUIRE(file->find_members("a").size() == 1u);
+}
+
+namespace
+{
+template <class Ref>
+std::string describe_ref(const Ref& ref)
+{
+    auto result = ref.name() + " ->";
+    for (auto& id : ref.id())
+        result += ' ' + std::to_string(static_cast<detail::hash_type>(id));
+    return result;
+}
+
+// the spelling of the type together with the entities it refers to
+std::string describe_type(const cpp_type& type)
+{
+    auto result = to_string(type);
+    switch (type.kind())
+    {
+    case cpp_type_kind::user_defined_t: {
+        auto& user_defined = static_cast<const cpp_user_defined_type&>(type);
+        result += " [" + describe_ref(user_defined.entity()) + "]";
+        break;
+    }
+    case cpp_type_kind::template_instantiation_t: {
+        auto& instantiation = static_cast<const cpp_template_instantiation_type&>(type);
+        result += " [" + describe_ref(instantiation.primary_template()) + "]";
+        break;
+    }
+    case cpp_type_kind::cv_qualified_t: {
+        auto& cv_qualified = static_cast<const cpp_cv_qualified_type&>(type);
+        result += " (" + describe_type(cv_qualified.type()) + ")";
+        break;
+    }
+    case cpp_type_kind::pointer_t:
+        result += " (" + describe_type(static_cast<const cpp_pointer_type&>(type).pointee()) + ")";
+        break;
+    case cpp_type_kind::reference_t: {
+        auto& reference = static_cast<const cpp_reference_type&>(type);
+        result += " (" + describe_type(reference.referee()) + ")";
+        break;
+    }
+    default:
+        break;
+    }
+    return result;
+}
+
+// the types of all variables and member variables in the code, by name
+std::map<std::string, std::string> variable_types(const char* code)
+{
+    cpp_entity_index idx;
+    auto             file = parse(idx, "libclang_parser_type_cache.cpp", code);
+
+    std::map<std::string, std::string> result;
+    visit(*file, [&](const cpp_entity& e, visitor_info) {
+        if (e.kind() == cpp_variable::kind())
+            result[e.name()] = describe_type(static_cast<const cpp_variable&>(e).type());
+        else if (e.kind() == cpp_member_variable::kind())
+            result[e.name()] = describe_type(static_cast<const cpp_member_variable&>(e).type());
+        return true;
+    });
+    return result;
+}
+
+// the types in the code must be the same as in the reference code,
+// where each variable is the only use of its type, so its type isn't taken from the cache
+void require_uncached_types(const char* code, std::initializer_list<const char*> references)
+{
+    auto types = variable_types(code);
+    for (auto reference : references)
+        for (auto& uncached : variable_types(reference))
+        {
+            INFO(uncached.first);
+            REQUIRE(types.count(uncached.first) == 1u);
+            REQUIRE(types[uncached.first] == uncached.second);
+        }
+}
+} // namespace
+
+TEST_CASE("libclang_parser type cache")
+{
+    SECTION("typedef inside and outside of its class")
+    {
+        require_uncached_types(R"(
+struct foo
+{
+    typedef int type;
+    type a;
+    type b;
+};
+
+foo::type c;
+foo::type d;
+
+struct bar
+{
+    foo::type e;
+    foo::type f;
+};
+)",
+                               {R"(
+struct foo
+{
+    typedef int type;
+    type a;
+};
+)",
+                                R"(
+struct foo
+{
+    typedef int type;
+    type b;
+};
+)",
+                                R"(
+struct foo
+{
+    typedef int type;
+};
+
+foo::type c;
+)",
+                                R"(
+struct foo
+{
+    typedef int type;
+};
+
+foo::type d;
+)",
+                                R"(
+struct foo
+{
+    typedef int type;
+};
+
+struct bar
+{
+    foo::type e;
+};
+)"});
+    }
+    SECTION("cv qualified record")
+    {
+        require_uncached_types(R"(
+struct foo {};
+
+foo a;
+extern const foo b;
+extern volatile foo c;
+extern const volatile foo d;
+foo e;
+extern const foo f;
+extern const volatile foo g;
+)",
+                               {"struct foo {}; foo a;", "struct foo {}; extern const foo b;",
+                                "struct foo {}; extern volatile foo c;",
+                                "struct foo {}; extern const volatile foo d;",
+                                "struct foo {}; foo e;", "struct foo {}; extern const foo f;",
+                                "struct foo {}; extern const volatile foo g;"});
+    }
+    SECTION("elaborated instantiation and plain type")
+    {
+        require_uncached_types(R"(
+template <typename T>
+struct foo
+{
+    foo* a;
+    foo<T>* b;
+    foo* c;
+};
+
+struct bar {};
+
+struct foo<int>* d;
+struct bar e;
+struct foo<int>* f;
+struct bar g;
+)",
+                               {R"(
+template <typename T>
+struct foo
+{
+    foo* a;
+};
+)",
+                                R"(
+template <typename T>
+struct foo
+{
+    foo<T>* b;
+};
+)",
+                                R"(
+template <typename T>
+struct foo
+{
+    foo* c;
+};
+)",
+                                "template <typename T> struct foo {}; struct foo<int>* d;",
+                                "struct bar {}; struct bar e;",
+                                "template <typename T> struct foo {}; struct foo<int>* f;",
+                                "struct bar {}; struct bar g;"});
+    }
+    SECTION("record inside a class template")
+    {
+        require_uncached_types(R"(
+template <typename T>
+struct outer
+{
+    struct inner {};
+    inner a;
+    inner b;
+};
+
+outer<int>::inner c;
+outer<int>::inner d;
+outer<float>::inner e;
+)",
+                               {R"(
+template <typename T>
+struct outer
+{
+    struct inner {};
+    inner a;
+};
+)",
+                                R"(
+template <typename T>
+struct outer
+{
+    struct inner {};
+    inner b;
+};
+)",
+                                R"(
+template <typename T>
+struct outer
+{
+    struct inner {};
+};
+
+outer<int>::inner c;
+)",
+                                R"(
+template <typename T>
+struct outer
+{
+    struct inner {};
+};
+
+outer<int>::inner d;
+)",
+                                R"(
+template <typename T>
+struct outer
+{
+    struct inner {};
+};
+
+outer<float>::inner e;
+)"});
+    }
 }
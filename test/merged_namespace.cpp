@@ -0,0 +1,59 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/merged_namespace.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+TEST_CASE("merged_namespace")
+{
+    cpp_entity_index idx;
+    auto             a = parse(idx, "merged_namespace_a.cpp", R"(
+namespace ns
+{
+    void f();
+    struct x {};
+}
+
+namespace ns {}
+
+namespace ns
+{
+    void f(int);
+}
+)");
+    auto             b = parse(idx, "merged_namespace_b.cpp", R"(
+namespace ns
+{
+    int y;
+    void f(float);
+}
+)");
+
+    merged_namespace ns(idx, "c:@N@ns"_id);
+    REQUIRE(ns.name() == "ns");
+    REQUIRE(ns.namespaces().size() == 4u);
+    REQUIRE(&ns.namespaces()[0u]->parent().value() == a.get());
+    REQUIRE(&ns.namespaces()[3u]->parent().value() == b.get());
+
+    std::vector<std::string> names;
+    for (auto& child : ns)
+        names.push_back(child.name());
+    REQUIRE(names == std::vector<std::string>{"f", "x", "f", "y", "f"});
+    REQUIRE(std::distance(ns.begin(), ns.end()) == 5);
+
+    auto f = ns.find_members("f");
+    REQUIRE(f.size() == 3u);
+    REQUIRE(&f[0u]->parent().value() == &*ns.namespaces()[0u]);
+    REQUIRE(&f[1u]->parent().value() == &*ns.namespaces()[2u]);
+    REQUIRE(&f[2u]->parent().value() == &*ns.namespaces()[3u]);
+    REQUIRE(ns.find_members("y").size() == 1u);
+    REQUIRE(ns.find_members("z").size() == 0u);
+
+    merged_namespace empty(idx, "c:@N@other"_id);
+    REQUIRE(empty.name().empty());
+    REQUIRE(empty.begin() == empty.end());
+    REQUIRE(empty.find_members("f").size() == 0u);
+}
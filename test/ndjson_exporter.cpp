@@ -0,0 +1,134 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/ndjson_exporter.hpp>
+
+#include <sstream>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+TEST_CASE("ndjson_exporter")
+{
+    auto code = R"(
+struct foo
+{
+    int a;
+
+private:
+    void f(foo b);
+};
+
+namespace ns
+{
+    int c;
+}
+)";
+
+    cpp_entity_index idx;
+    auto             file = parse(idx, "ndjson_exporter.cpp", code);
+
+    std::ostringstream out;
+    {
+        // small buffer to force intermediate flushes
+        ndjson_exporter exporter(out, 16u);
+        exporter.write(*file);
+    }
+
+    std::vector<std::string> lines;
+    std::istringstream       in(out.str());
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+
+    auto find = [&](const char* str) {
+        for (auto& line : lines)
+            if (line.find(str) != std::string::npos)
+                return line;
+        FAIL("no record containing " << str);
+        return std::string();
+    };
+
+    REQUIRE(lines.size() == 8u); // includes the access specifier
+    REQUIRE(lines[0]
+            == R"({"id":1,"parent":0,"kind":"file","name":"ndjson_exporter.cpp","definition":false})");
+    REQUIRE(lines[1] == R"({"id":2,"parent":1,"kind":"class","name":"foo","definition":true})");
+    REQUIRE(find(R"("name":"a")")
+            == R"({"id":3,"parent":2,"kind":"member variable","name":"a","access":"public","definition":false,"type":"int"})");
+
+    auto f = find(R"("name":"f")");
+    REQUIRE(f.find(R"("parent":2,"kind":"member function","name":"f","access":"private")")
+            != std::string::npos);
+    auto b = find(R"("name":"b")");
+    REQUIRE(b.find(R"("kind":"function parameter")") != std::string::npos);
+    REQUIRE(b.find(R"("refs":[{"name":"foo","target":[")") != std::string::npos);
+
+    REQUIRE(find(R"("name":"ns")").find(R"("id":7,"parent":1,"kind":"namespace")")
+            != std::string::npos);
+    REQUIRE(find(R"("name":"c")").find(R"("id":8,"parent":7,"kind":"variable")")
+            != std::string::npos);
+}
+
+TEST_CASE("ndjson_exporter templates")
+{
+    auto code = R"(
+template <typename T, int N>
+T f(T a);
+
+template <typename T>
+struct bar
+{
+    T d;
+};
+
+template <typename T, template <typename> class U>
+using g = bar<T>;
+)";
+
+    cpp_entity_index idx;
+    auto             file = parse(idx, "ndjson_exporter_templates.cpp", code);
+
+    std::ostringstream out;
+    {
+        ndjson_exporter exporter(out);
+        exporter.write(*file);
+    }
+
+    std::vector<std::string> lines;
+    std::istringstream       in(out.str());
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+    REQUIRE(lines.size() == 12u);
+
+    auto contains = [&](std::size_t i, const char* str) {
+        INFO(lines[i]);
+        return lines[i].find(str) != std::string::npos;
+    };
+
+    SECTION("function template")
+    {
+        REQUIRE(contains(1u, R"("id":2,"parent":1,"kind":"function template","name":"f")"));
+        REQUIRE(contains(1u, R"("type":"T","refs":[{"name":"T","target":[")"));
+        REQUIRE(contains(2u, R"("id":3,"parent":2,"kind":"template type parameter","name":"T")"));
+        REQUIRE(contains(3u, R"("id":4,"parent":2,"kind":"non type template parameter")"));
+        REQUIRE(contains(3u, R"("type":"int")"));
+        REQUIRE(contains(4u, R"("id":5,"parent":2,"kind":"function parameter","name":"a")"));
+        REQUIRE(contains(4u, R"("type":"T")"));
+    }
+    SECTION("class template")
+    {
+        REQUIRE(contains(5u, R"("id":6,"parent":1,"kind":"class template","name":"bar")"));
+        REQUIRE(contains(6u, R"("id":7,"parent":6,"kind":"template type parameter","name":"T")"));
+        REQUIRE(contains(7u, R"("id":8,"parent":6,"kind":"member variable","name":"d")"));
+        REQUIRE(contains(7u, R"("type":"T")"));
+    }
+    SECTION("alias template")
+    {
+        REQUIRE(contains(8u, R"("id":9,"parent":1,"kind":"alias template","name":"g")"));
+        REQUIRE(contains(8u, R"("type":"bar<T>","refs":[{"name":"bar","target":[")"));
+        REQUIRE(contains(8u, R"({"name":"T","target":[")"));
+        REQUIRE(contains(9u, R"("id":10,"parent":9,"kind":"template type parameter")"));
+        REQUIRE(contains(10u, R"("id":11,"parent":9,"kind":"template template parameter")"));
+        REQUIRE(contains(11u, R"("id":12,"parent":11,"kind":"template type parameter")"));
+    }
+}
@@ -56,3 +56,76 @@ TEST_CASE("parse_files")
     for (auto& file : parser.files())
         REQUIRE(file.name() == *iter++);
 }
+
+namespace
+{
+class shared_compile_config : public compile_config
+{
+public:
+    shared_compile_config() : compile_config({}) {}
+
+private:
+    void do_set_flags(cpp_standard, compile_flags) override {}
+
+    void do_add_include_dir(std::string) override {}
+
+    void do_add_macro_definition(std::string, std::string) override {}
+
+    void do_remove_macro_definition(std::string) override {}
+
+    const char* do_get_name() const noexcept override
+    {
+        return "shared";
+    }
+};
+
+unsigned shared_configs_created = 0u;
+
+class shared_parser : public parser
+{
+public:
+    using config = shared_compile_config;
+
+    struct shared_config
+    {
+        explicit shared_config(const shared_compile_config&)
+        {
+            ++shared_configs_created;
+        }
+    };
+
+    shared_parser() : parser(type_safe::ref(logger_)) {}
+
+    using parser::parse;
+
+    std::unique_ptr<cpp_file> parse(const cpp_entity_index& idx, std::string path,
+                                    const shared_config&) const
+    {
+        return cpp_file::builder(std::move(path)).finish(idx);
+    }
+
+private:
+    std::unique_ptr<cpp_file> do_parse(const cpp_entity_index&, std::string,
+                                       const compile_config&) const override
+    {
+        FAIL("shared configuration not used");
+        return nullptr;
+    }
+
+    stderr_diagnostic_logger logger_;
+};
+} // namespace
+
+TEST_CASE("parse_files with shared_config")
+{
+    cpp_entity_index                  idx;
+    simple_file_parser<shared_parser> parser(type_safe::ref(idx));
+
+    auto file_names = {"a.cpp", "b.cpp", "c.cpp"};
+    parse_files(parser, file_names, shared_compile_config());
+    REQUIRE(shared_configs_created == 1u);
+
+    auto iter = file_names.begin();
+    for (auto& file : parser.files())
+        REQUIRE(file.name() == *iter++);
+}
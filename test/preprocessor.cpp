@@ -307,3 +307,59 @@ void j();
     }
     REQUIRE((file->unmatched_comments().size() == 3u + add));
 }
+
+TEST_CASE("comment table")
+{
+    auto code = R"(
+/// a
+struct a {};
+
+/// u
+
+/** b */
+void b();
+)";
+
+    auto  file  = parse({}, "comment-table.cpp", code);
+    auto& table = file->comment_table();
+    REQUIRE(table.size() == 3u);
+    REQUIRE(table.text(0u) == "a");
+    REQUIRE(table.text(1u) == "u");
+    REQUIRE(table[2u].line == 7u);
+
+    REQUIRE(table.lookup(2u));
+    REQUIRE(table.lookup(2u).value() == "a");
+    REQUIRE(!table.lookup(3u));
+
+    // entities share the text stored in the table
+    visit(*file, [&](const cpp_entity& e, visitor_info) {
+        if (e.kind() == cpp_entity_kind::file_t)
+            return true;
+        REQUIRE(e.comment());
+        REQUIRE(e.comment().value() == e.name());
+        REQUIRE(&e.comment().value() == &table.lookup(e.name() == "a" ? 2u : 7u).value());
+        return true;
+    });
+
+    REQUIRE((file->unmatched_comments().size() == 1u));
+}
+
+TEST_CASE("empty comment")
+{
+    auto code = R"(
+///
+struct a {};
+struct b {};
+)";
+
+    auto file = parse({}, "empty-comment.cpp", code);
+    REQUIRE(file->comment_table().size() == 1u);
+
+    // the empty comment is matched with a, but neither has a comment
+    visit(*file, [&](const cpp_entity& e, visitor_info) {
+        if (e.kind() != cpp_entity_kind::file_t)
+            REQUIRE(!e.comment());
+        return true;
+    });
+    REQUIRE(file->unmatched_comments().size() == 0u);
+}
@@ -0,0 +1,115 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/qualified_name_index.hpp>
+
+#include <cppast/cpp_function.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+TEST_CASE("qualified_name_index")
+{
+    cpp_entity_index idx;
+    REQUIRE(!idx.qualified_names());
+    idx.enable_qualified_name_index();
+    REQUIRE(idx.qualified_names());
+
+    auto file = parse(idx, "qualified_name_index.cpp", R"(
+namespace ns
+{
+    namespace detail
+    {
+        void foo();
+        void foo(int);
+    }
+
+    struct bar
+    {
+        int foo;
+    };
+
+    template <typename T>
+    struct baz
+    {
+        void foo();
+    };
+
+    enum color
+    {
+        red,
+    };
+
+    enum class scoped
+    {
+        value,
+    };
+
+    namespace
+    {
+        int hidden;
+    }
+}
+
+void foo();
+)");
+
+    auto& names = idx.qualified_names().value();
+
+    auto get_names = [](const std::vector<type_safe::object_ref<const cpp_entity>>& entities) {
+        std::vector<std::string> result;
+        for (auto& e : entities)
+            result.push_back(e->name());
+        return result;
+    };
+    auto get_kinds = [](const std::vector<type_safe::object_ref<const cpp_entity>>& entities) {
+        std::vector<cpp_entity_kind> result;
+        for (auto& e : entities)
+            result.push_back(e->kind());
+        return result;
+    };
+
+    SECTION("exact")
+    {
+        auto overloads = names.lookup("ns::detail::foo");
+        REQUIRE(overloads.size() == 2u);
+        REQUIRE(static_cast<const cpp_function&>(*overloads[0]).parameters().empty());
+        REQUIRE(!static_cast<const cpp_function&>(*overloads[1]).parameters().empty());
+
+        REQUIRE(get_kinds(names.lookup("foo"))
+                == std::vector<cpp_entity_kind>{cpp_entity_kind::function_t});
+        REQUIRE(get_kinds(names.lookup("ns::bar::foo"))
+                == std::vector<cpp_entity_kind>{cpp_entity_kind::member_variable_t});
+        REQUIRE(get_kinds(names.lookup("ns::baz"))
+                == std::vector<cpp_entity_kind>{cpp_entity_kind::class_template_t});
+        REQUIRE(get_kinds(names.lookup("ns::baz::foo"))
+                == std::vector<cpp_entity_kind>{cpp_entity_kind::member_function_t});
+        REQUIRE(names.lookup("ns::red").size() == 1u);
+        REQUIRE(names.lookup("ns::color::red").empty());
+        REQUIRE(names.lookup("ns::scoped::value").size() == 1u);
+        REQUIRE(names.lookup("ns::hidden").size() == 1u);
+        REQUIRE(names.lookup("ns::foo").empty());
+        REQUIRE(names.lookup("ns::de").empty());
+    }
+    SECTION("prefix")
+    {
+        REQUIRE(get_names(names.lookup_prefix("ns::detail::"))
+                == std::vector<std::string>{"foo", "foo"});
+        REQUIRE(get_names(names.lookup_prefix("ns::b"))
+                == std::vector<std::string>{"bar", "foo", "baz", "foo"});
+        REQUIRE(names.lookup_prefix("ns::").size() == 12u);
+        REQUIRE(names.lookup_prefix("").size() == names.size());
+        REQUIRE(names.lookup_prefix("std::").empty());
+    }
+    SECTION("glob")
+    {
+        REQUIRE(names.lookup_glob("ns::*::foo").size() == 4u);
+        REQUIRE(names.lookup_glob("*foo").size() == 5u);
+        REQUIRE(get_names(names.lookup_glob("ns::ba?")) == std::vector<std::string>{"bar", "baz"});
+        REQUIRE(names.lookup_glob("ns::detail::foo").size() == 2u);
+        REQUIRE(names.lookup_glob("ns::*r").size() == 2u);
+        REQUIRE(names.lookup_glob("ns::b*z*").size() == 2u);
+        REQUIRE(names.lookup_glob("ns::x*").empty());
+    }
+}
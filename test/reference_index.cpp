@@ -0,0 +1,79 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/reference_index.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+TEST_CASE("reference_index")
+{
+    cpp_entity_index idx;
+    auto             file = parse(idx, "reference_index.cpp", R"(
+struct x {};
+
+template <typename T>
+struct wrapper {};
+
+struct derived : x
+{
+    x member;
+    wrapper<x>* wrapped;
+
+    derived(const x&);
+};
+
+x* get(x, const x&);
+void set(wrapper<x>);
+
+using alias = x[4];
+x variable;
+
+int unrelated(int);
+)");
+
+    auto get_names = [](const std::vector<type_safe::object_ref<const cpp_entity>>& entities) {
+        std::vector<std::string> result;
+        for (auto& e : entities)
+            result.push_back(e->name());
+        return result;
+    };
+
+    auto check = [&](const reference_index& refs) {
+        REQUIRE(refs.lookup("c:@S@x"_id).size() == 9u);
+        REQUIRE(get_names(refs.lookup("c:@S@x"_id, cpp_reference_role::base))
+                == std::vector<std::string>{"derived"});
+        REQUIRE(get_names(refs.lookup("c:@S@x"_id, cpp_reference_role::member))
+                == std::vector<std::string>{"member", "wrapped"});
+        REQUIRE(get_names(refs.lookup("c:@S@x"_id, cpp_reference_role::parameter))
+                == std::vector<std::string>{"derived", "get", "set"});
+        REQUIRE(get_names(refs.lookup("c:@S@x"_id, cpp_reference_role::return_type))
+                == std::vector<std::string>{"get"});
+        REQUIRE(get_names(refs.lookup("c:@S@x"_id, cpp_reference_role::alias))
+                == std::vector<std::string>{"alias"});
+        REQUIRE(get_names(refs.lookup("c:@S@x"_id, cpp_reference_role::variable))
+                == std::vector<std::string>{"variable"});
+
+        REQUIRE(get_names(refs.lookup("c:@ST>1#T@wrapper"_id, cpp_reference_role::member))
+                == std::vector<std::string>{"wrapped"});
+        REQUIRE(get_names(refs.lookup("c:@ST>1#T@wrapper"_id, cpp_reference_role::parameter))
+                == std::vector<std::string>{"set"});
+
+        REQUIRE(refs.lookup("c:@S@derived"_id).empty());
+        REQUIRE(refs.size() == 2u);
+    };
+
+    SECTION("single file")
+    {
+        reference_index refs;
+        refs.add(*file);
+        check(refs);
+    }
+    SECTION("parallel")
+    {
+        reference_index refs;
+        refs.add(std::vector<const cpp_file*>{file.get()}, 4u);
+        check(refs);
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/side_table.hpp>
+
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_function.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+TEST_CASE("dense_index")
+{
+    cpp_entity_index idx;
+    auto             file_a = parse(idx, "side_table_a.cpp", R"(
+void a(int param);
+struct b {};
+)");
+    auto             file_b = parse(idx, "side_table_b.cpp", "int c;");
+
+    // file, a, param, b
+    REQUIRE(file_a->dense_index() == 0u);
+    // file, c
+    REQUIRE(file_b->dense_index() == 4u);
+    REQUIRE(idx.dense_index_count() == 6u);
+
+    auto count = 0u;
+    for (auto i = 0u; i != idx.dense_index_count(); ++i)
+    {
+        auto entity = idx.lookup_dense_index(i);
+        REQUIRE(entity);
+        REQUIRE(entity.value().dense_index() == i);
+        ++count;
+    }
+    REQUIRE(count == 6u);
+    REQUIRE(!idx.lookup_dense_index(6u));
+
+    auto& func = static_cast<const cpp_function&>(*file_a->begin());
+    REQUIRE(func.name() == "a");
+    REQUIRE((*func.parameters().begin()).dense_index() == func.dense_index() + 1u);
+
+    SECTION("side_table")
+    {
+        side_table<int> table(idx);
+        REQUIRE(table.size() == 6u);
+        table[func] = 42;
+        REQUIRE(table.lookup(func).value() == 42);
+        REQUIRE(table.lookup(*file_b).value() == 0);
+
+        side_table<int> empty;
+        REQUIRE(!empty.lookup(func));
+        empty[*file_b] = 1;
+        REQUIRE(empty.size() == 6u);
+    }
+    SECTION("entity_bitset")
+    {
+        entity_bitset a(idx), b;
+        REQUIRE(a.empty());
+        REQUIRE(a == b);
+
+        REQUIRE(a.insert(func));
+        REQUIRE(!a.insert(func));
+        REQUIRE(a.insert(*file_b));
+        REQUIRE(b.insert(*file_b));
+        REQUIRE(a.count() == 2u);
+        REQUIRE(a.contains(func));
+        REQUIRE(!b.contains(func));
+
+        REQUIRE((a & b) == b);
+        REQUIRE((a | b) == a);
+        REQUIRE((a - b).count() == 1u);
+        REQUIRE((a - b).contains(func));
+
+        std::vector<std::uint_least32_t> indices;
+        a.for_each([&](std::uint_least32_t index) { indices.push_back(index); });
+        REQUIRE(indices == std::vector<std::uint_least32_t>{func.dense_index(),
+                                                            file_b->dense_index()});
+
+        a.erase(func);
+        REQUIRE(a == b);
+    }
+}
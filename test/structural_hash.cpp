@@ -0,0 +1,67 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/structural_hash.hpp>
+
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_variable.hpp>
+
+#include "test_parser.hpp"
+
+using namespace cppast;
+
+namespace
+{
+const cpp_entity& find_child(const cpp_file& file, const char* name)
+{
+    for (auto& child : file)
+        if (child.name() == name)
+            return child;
+    FAIL("no entity named " << name);
+    return file;
+}
+} // namespace
+
+TEST_CASE("structural_hash")
+{
+    auto code_a = R"(
+/// a
+struct a
+{
+    int member;
+    void f(const a& other) const;
+};
+
+int b = 42;
+)";
+    auto code_b = R"(
+/// a
+struct a
+{
+    int member;
+    void f(const a& other) const;
+};
+
+long b = 42;
+)";
+
+    cpp_entity_index idx_a, idx_b, idx_c;
+    auto             file_a = parse(idx_a, "structural_hash_a.cpp", code_a);
+    auto             file_b = parse(idx_b, "structural_hash_a.cpp", code_a);
+    auto             file_c = parse(idx_c, "structural_hash_a.cpp", code_b);
+
+    // same code, different parse
+    REQUIRE(structural_hash(*file_a) == structural_hash(*file_b));
+    // cached
+    REQUIRE(structural_hash(*file_a) == structural_hash(*file_a));
+
+    // only b changed
+    REQUIRE(structural_hash(*file_a) != structural_hash(*file_c));
+    REQUIRE(structural_hash(find_child(*file_a, "a")) == structural_hash(find_child(*file_c, "a")));
+    REQUIRE(structural_hash(find_child(*file_a, "b")) != structural_hash(find_child(*file_c, "b")));
+
+    auto& var_a = static_cast<const cpp_variable&>(find_child(*file_a, "b"));
+    auto& var_c = static_cast<const cpp_variable&>(find_child(*file_c, "b"));
+    REQUIRE(structural_hash(var_a.type()) == structural_hash(*cpp_builtin_type::build(cpp_int)));
+    REQUIRE(structural_hash(var_a.type()) != structural_hash(var_c.type()));
+}
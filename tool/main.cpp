@@ -10,6 +10,7 @@
 #include <cppast/cpp_forward_declarable.hpp> // for is_definition()
 #include <cppast/cpp_namespace.hpp>          // for cpp_namespace
 #include <cppast/libclang_parser.hpp> // for libclang_parser, libclang_compile_config, cpp_entity,...
+#include <cppast/ndjson_exporter.hpp> // for ndjson_exporter
 #include <cppast/visitor.hpp>         // for visit()
 
 // print help options
@@ -196,6 +197,7 @@ try
         ("version", "display version information and exit")
         ("v,verbose", "be verbose when parsing")
         ("fatal_errors", "abort program when a parser error occurs, instead of doing error correction")
+        ("ndjson", "print the AST as newline-delimited JSON, one record per entity")
         ("file", "the file that is being parsed (last positional argument)",
          cxxopts::value<std::string>());
     option_list.add_options("compilation")
@@ -325,7 +327,10 @@ try
                                options.count("fatal_errors") == 1);
         if (!file)
             return 2;
-        print_ast(std::cout, *file);
+        else if (options.count("ndjson"))
+            cppast::ndjson_exporter(std::cout).write(*file);
+        else
+            print_ast(std::cout, *file);
     }
 }
 catch (const cppast::libclang_error& ex)